@@ -0,0 +1,351 @@
+#include "App.h"
+#include "LineSink.h"
+#include "Profiler.h"
+#include "SoftwareRasterizer.h"
+#include <cmath>
+#include <cstdio>
+#include <span>
+
+namespace {
+
+//カメラの最初の位置
+const Vec3 kCamaraTranslate = {0.0f, 1.9f, -6.49f};
+const Vec3 kCamaraRotate = {0.26f, 0.0f, 0.0f};
+
+} // namespace
+
+FrameInput MakeInitialFrameInput() {
+	FrameInput input = {};
+	input.camaraTranslate = kCamaraTranslate;
+	input.camaraRotate = kCamaraRotate;
+	input.point1 = {{0.0f, 0.0f, 0.0f} , 0.6f};
+	input.point2 = {{0.0f, 1.0f, 0.0f}, 1.0f};
+	return input;
+}
+
+void InitializeApp(AppState &app , const FrameInput &input) {
+	InitializeScene(app.scene , 1024 , 64);
+	app.point1Handle = AddSphere(app.scene , input.point1 , kColorWhite);
+	app.point2Handle = AddPlane(app.scene , input.point2 , kColorWhite);
+	app.debugSpheres.clear();
+	app.bvhSphereCount = 0;
+	app.isPicked = false;
+}
+
+void UpdateApp(AppState &app , const FrameInput &input , RenderContext &renderContext) {
+	{
+		ProfileScope scope(kProfileUpdate);
+
+		renderContext.isSphereHiddenLine = input.isSphereHiddenLine;
+		SetSphere(app.scene , app.point1Handle , input.point1);
+		SetPlane(app.scene , app.point2Handle , input.point2);
+
+		//数が変わった時だけ並べ直す
+		if (app.debugSpheres.size() != size_t(input.debugSphereCount)) {
+			const int kRowCount = 100;
+			app.debugSpheres.clear();
+			for (int i = 0; i < input.debugSphereCount; ++i) {
+				Vec3 center = {float(i % kRowCount - kRowCount / 2) * 0.3f, -1.0f, float(i / kRowCount) * 0.3f};
+				app.debugSpheres.push_back({{center, 0.1f}, 0x4080FFFF});
+			}
+		}
+
+		UpdateRenderContext(renderContext , input.camaraTranslate , input.camaraRotate);
+	}
+	{
+		ProfileScope scope(kProfileCollision);
+		UpdateSceneCollision(app.scene);
+	}
+	{
+		ProfileScope scope(kProfileUpdate);
+
+		//球の数が変わった時だけ作り直し、それ以外は箱の更新だけ
+		const SoAPool<4> &spheres = app.scene.spheres;
+		if (spheres.count != app.bvhSphereCount || app.bvh.GetNodeCount() == 0) {
+			app.bvh.Build(spheres.columns[0] , spheres.columns[1] , spheres.columns[2] , spheres.columns[3] , spheres.count);
+			app.bvhSphereCount = spheres.count;
+		} else {
+			app.bvh.Refit(spheres.columns[0] , spheres.columns[1] , spheres.columns[2] , spheres.columns[3]);
+		}
+		app.bvhPlanes.clear();
+		for (uint32_t i = 0; i < app.scene.planes.count; ++i) {
+			app.bvhPlanes.push_back(GetPlaneAt(app.scene , i));
+		}
+		app.bvh.SetPlanes(app.bvhPlanes.data() , app.bvhPlanes.size());
+
+		//マウスの位置のニア面からファー面までのレイ
+		Matrix4x4 screenToWorld = Inverse(renderContext.viewProjectionViewportMatrix);
+		Vec3 nearPoint = Transform({float(input.mouseX), float(input.mouseY), 0.0f} , screenToWorld);
+		Vec3 farPoint = Transform({float(input.mouseX), float(input.mouseY), 1.0f} , screenToWorld);
+		app.isPicked = app.bvh.Raycast({nearPoint, Subtract(farPoint , nearPoint)} , 1.0f , app.pickedHit);
+	}
+}
+
+void WriteSnapshot(const AppState &app , const RenderContext &renderContext , FrameSnapshot &snapshot) {
+	snapshot.renderContext = renderContext;
+
+	const SoAPool<4> &spheres = app.scene.spheres;
+	snapshot.spheres.x.assign(spheres.columns[0] , spheres.columns[0] + spheres.count);
+	snapshot.spheres.y.assign(spheres.columns[1] , spheres.columns[1] + spheres.count);
+	snapshot.spheres.z.assign(spheres.columns[2] , spheres.columns[2] + spheres.count);
+	snapshot.spheres.radius.assign(spheres.columns[3] , spheres.columns[3] + spheres.count);
+	snapshot.sphereColors.assign(spheres.colors , spheres.colors + spheres.count);
+
+	const SoAPool<4> &planes = app.scene.planes;
+	snapshot.planes.resize(planes.count);
+	for (uint32_t i = 0; i < planes.count; ++i) {
+		snapshot.planes[i] = GetPlaneAt(app.scene , i);
+	}
+	snapshot.planeColors.assign(planes.colors , planes.colors + planes.count);
+
+	snapshot.debugSpheres = app.debugSpheres;
+}
+
+uint32_t DrawSnapshot(const FrameSnapshot &snapshot , JobSystem &jobSystem , const SceneFile &sceneFile , LineBatch &lineBatch , ProfileCounterBlock &counters) {
+	RenderContext renderContext = snapshot.renderContext;
+	renderContext.lineSink = &lineBatch;
+	renderContext.counters = &counters;
+	DrawGrid(renderContext);
+
+	//球と平面はジオメトリを並列に作る
+	uint32_t sphereCount = uint32_t(snapshot.spheres.size());
+	uint32_t planeCount = uint32_t(snapshot.planes.size());
+	uint32_t drawnCount = DrawParallel(jobSystem , renderContext , sphereCount + planeCount , lineBatch , [&](size_t index , const RenderContext &chunkContext) {
+		if (index < sphereCount) {
+			Sphere sphere = {{snapshot.spheres.x[index], snapshot.spheres.y[index], snapshot.spheres.z[index]}, snapshot.spheres.radius[index]};
+			return DrawSphere(sphere , chunkContext , snapshot.sphereColors[index]);
+		}
+		size_t planeIndex = index - sphereCount;
+		return DrawPlane(snapshot.planes[planeIndex] , chunkContext , snapshot.planeColors[planeIndex]);
+	});
+	drawnCount += DrawSceneFile(jobSystem , renderContext , sceneFile , lineBatch);
+
+	//デバッグ用の球はチャンクごとにまとめてインスタンス描画する
+	std::span<const SphereInstance> debugSpan = snapshot.debugSpheres;
+	drawnCount += DrawParallelChunks(jobSystem , renderContext , debugSpan.size() , lineBatch , [&](size_t begin , size_t end , const RenderContext &chunkContext) {
+		return DrawSphereInstances(debugSpan.subspan(begin , end - begin) , chunkContext);
+	});
+
+	//描画スレッドで消しておけば、線を送るメインスレッドは並べ替えを待たない
+	if (renderContext.isDeduplicateLines) {
+		lineBatch.Deduplicate();
+	}
+	return drawnCount;
+}
+
+CommandLineOptions ParseCommandLine(std::istream &commandLine) {
+	CommandLineOptions options;
+	std::string option;
+	while (commandLine >> option) {
+		if (option == "-scene") {
+			commandLine >> options.scenePath;
+		} else if (option == "-latency") {
+			commandLine >> options.latency;
+		} else if (option == "-record") {
+			commandLine >> options.recordPath;
+		} else if (option == "-dedup") {
+			options.isDeduplicateLines = true;
+		} else if (option == "-headless") {
+			options.mode = kRunHeadless;
+			commandLine >> options.frameCount >> options.outputPath >> options.csvPath;
+			break;
+		} else if (option == "-replay") {
+			options.mode = kRunReplay;
+			commandLine >> options.inputPath >> options.csvPath >> options.outputPath;
+			break;
+		}
+	}
+	return options;
+}
+
+int RunWithoutWindow(const CommandLineOptions &options) {
+	if (options.mode == kRunHeadless) {
+		return RunHeadless(options.frameCount , options.outputPath , options.csvPath , options.scenePath , options.isDeduplicateLines);
+	}
+	if (options.mode == kRunReplay) {
+		return RunReplay(options.inputPath , options.csvPath , options.outputPath , options.scenePath , options.latency , options.isDeduplicateLines);
+	}
+	return 1;
+}
+
+int RunHeadless(int frameCount , const std::string &outputPath , const std::string &csvPath , const std::string &scenePath , bool isDeduplicateLines) {
+	SceneFile sceneFile;
+	if (!scenePath.empty() && !sceneFile.Open(scenePath.c_str())) {
+		return 1;
+	}
+
+	FILE *csvFile = nullptr;
+	if (!csvPath.empty()) {
+#if defined(_MSC_VER)
+		fopen_s(&csvFile , csvPath.c_str() , "w");
+#else
+		csvFile = std::fopen(csvPath.c_str() , "w");
+#endif
+		if (csvFile == nullptr) {
+			return 1;
+		}
+		Profiler::WriteCSVHeader(csvFile);
+	}
+	Profiler *profiler = Profiler::GetInstance();
+
+	SoftwareRasterizer rasterizer(1280 , 720);
+	LineBatch lineBatch;
+
+	Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f , 1280.0f / 720.0f , 0.1f , 100.0f);
+	Matrix4x4 viewportMatrix = MakeViewportMatrix(0 , 0 , 1280.0f , 720.0f , 0.0f , 1.0f);
+	RenderContext renderContext = MakeRenderContext(projectionMatrix , viewportMatrix , &lineBatch);
+	JobSystem jobSystem;
+
+	Scene scene;
+	InitializeScene(scene , 1024 , 64);
+	SceneHandle point1 = AddSphere(scene , {{0.0f, 0.0f, 0.0f} , 0.6f} , kColorWhite);
+	AddPlane(scene , {{0.0f, 1.0f, 0.0f}, 1.0f} , kColorWhite);
+
+	for (int frame = 0; frame < frameCount; ++frame) {
+		{
+			ProfileScope scope(kProfileUpdate);
+
+			//球を上下に動かして平面との当たりが切り替わるようにする
+			Sphere sphere = GetSphere(scene , point1);
+			sphere.center.y = std::sin(float(frame) * 0.05f) * 1.5f;
+			SetSphere(scene , point1 , sphere);
+
+			UpdateRenderContext(renderContext , kCamaraTranslate , kCamaraRotate);
+		}
+		{
+			ProfileScope scope(kProfileCollision);
+			UpdateSceneCollision(scene);
+		}
+		{
+			ProfileScope scope(kProfileGeometry);
+			DrawGrid(renderContext);
+			DrawScene(jobSystem , renderContext , scene , lineBatch);
+			DrawSceneFile(jobSystem , renderContext , sceneFile , lineBatch);
+			if (isDeduplicateLines) {
+				lineBatch.Deduplicate();
+			}
+		}
+		{
+			ProfileScope scope(kProfileSubmission);
+			profiler->AddCount(kProfileLines , lineBatch.GetCount());
+			rasterizer.Clear(0x1A1A1AFF);
+			lineBatch.Flush(rasterizer);
+		}
+
+		profiler->EndFrame();
+		if (csvFile) {
+			profiler->WriteCSVRow(csvFile);
+		}
+	}
+
+	if (csvFile) {
+		std::fclose(csvFile);
+	}
+	if (!outputPath.empty() && !rasterizer.SavePPM(outputPath.c_str())) {
+		return 1;
+	}
+	return 0;
+}
+
+int RunReplay(const std::string &inputPath , const std::string &csvPath , const std::string &outputPath , const std::string &scenePath , uint32_t latency , bool isDeduplicateLines) {
+	InputPlayer player;
+	if (!player.Open(inputPath.c_str())) {
+		return 1;
+	}
+	SceneFile sceneFile;
+	if (!scenePath.empty() && !sceneFile.Open(scenePath.c_str())) {
+		return 1;
+	}
+
+	FILE *csvFile = nullptr;
+	if (!csvPath.empty()) {
+#if defined(_MSC_VER)
+		fopen_s(&csvFile , csvPath.c_str() , "w");
+#else
+		csvFile = std::fopen(csvPath.c_str() , "w");
+#endif
+		if (csvFile == nullptr) {
+			return 1;
+		}
+		std::fprintf(csvFile , "frame,snapshot_frame,frame_ms,update_ms,collision_ms,geometry_ms,submission_ms,lines,checksum\n");
+	}
+	Profiler *profiler = Profiler::GetInstance();
+
+	//ウィンドウと同じ大きさの画像に描く
+	SoftwareRasterizer rasterizer(1280 , 720);
+	ChecksumLineSink checksumSink(&rasterizer);
+
+	Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f , 1280.0f / 720.0f , 0.1f , 100.0f);
+	Matrix4x4 viewportMatrix = MakeViewportMatrix(0 , 0 , 1280.0f , 720.0f , 0.0f , 1.0f);
+	//線はスナップショットを描く時に描画側のバッチへ差し替える
+	RenderContext renderContext = MakeRenderContext(projectionMatrix , viewportMatrix , &checksumSink);
+	renderContext.isDeduplicateLines = isDeduplicateLines;
+	JobSystem jobSystem;
+	RenderPipeline pipeline(jobSystem , sceneFile , latency);
+
+	AppState app;
+	InitializeApp(app , MakeInitialFrameInput());
+
+	double totalMilliseconds = 0.0;
+	uint32_t frame = 0;
+	//描き終わった線を画像に送って、1行書く
+	auto submitFrame = [&](const RenderedFrame &rendered , std::chrono::steady_clock::time_point start) {
+		size_t lineCount = 0;
+		if (rendered.lines) {
+			profiler->AddStageTime(kProfileGeometry , rendered.geometryMilliseconds);
+			profiler->AddCounts(rendered.counters);
+			ProfileScope scope(kProfileSubmission);
+			lineCount = rendered.lines->GetCount();
+			profiler->AddCount(kProfileLines , lineCount);
+			rasterizer.Clear(0x1A1A1AFF);
+			rendered.lines->Flush(checksumSink);
+		}
+		profiler->EndFrame();
+
+		double frameMilliseconds = std::chrono::duration<double , std::milli>(std::chrono::steady_clock::now() - start).count();
+		totalMilliseconds += frameMilliseconds;
+		if (csvFile) {
+			const Profiler::FrameRecord &record = profiler->GetLatestRecord();
+			//latencyが1の最初のフレームはまだ線が無いので、snapshot_frameは空にする
+			if (rendered.lines) {
+				std::fprintf(csvFile , "%u,%llu," , frame , static_cast<unsigned long long>(rendered.frame));
+			} else {
+				std::fprintf(csvFile , "%u,," , frame);
+			}
+			std::fprintf(csvFile , "%.4f,%.4f,%.4f,%.4f,%.4f,%zu,%016llx\n" , frameMilliseconds ,
+				record.stageMilliseconds[kProfileUpdate] , record.stageMilliseconds[kProfileCollision] ,
+				record.stageMilliseconds[kProfileGeometry] , record.stageMilliseconds[kProfileSubmission] ,
+				lineCount , static_cast<unsigned long long>(checksumSink.GetChecksum()));
+		}
+	};
+
+	FrameInput input;
+	while (player.Next(input)) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		UpdateApp(app , input , renderContext);
+		WriteSnapshot(app , renderContext , pipeline.GetWritableSnapshot());
+		submitFrame(pipeline.Submit() , start);
+		++frame;
+	}
+	//1フレーム遅れている分を出す
+	RenderedFrame last = pipeline.Drain();
+	if (last.lines) {
+		submitFrame(last , std::chrono::steady_clock::now());
+	}
+
+	if (csvFile) {
+		std::fclose(csvFile);
+	}
+	std::printf("frames %u total %.3f ms average %.4f ms checksum %016llx\n" , frame , totalMilliseconds ,
+		frame > 0 ? totalMilliseconds / frame : 0.0 , static_cast<unsigned long long>(checksumSink.GetChecksum()));
+
+	//途中で壊れていたら失敗にする
+	if (frame != player.GetFrameCount()) {
+		return 1;
+	}
+	if (!outputPath.empty() && !rasterizer.SavePPM(outputPath.c_str())) {
+		return 1;
+	}
+	return 0;
+}
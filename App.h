@@ -0,0 +1,231 @@
+#pragma once
+#include "BVH.h"
+#include "InputRecord.h"
+#include "JobSystem.h"
+#include "LineBatch.h"
+#include "Profiler.h"
+#include "Render.h"
+#include "Scene.h"
+#include "SceneFile.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//ウィンドウのループ・ヘッドレス・リプレイで共通の更新と描画(Noviceに依存しない)
+
+//ウィンドウのループとリプレイで共通の状態
+struct AppState {
+	Scene scene;
+	SceneHandle point1Handle;
+	SceneHandle point2Handle;
+	//インスタンス描画の確認用に地面に並べる球(当たり判定はしない)
+	std::vector<SphereInstance> debugSpheres;
+	//マウスで選ぶ用
+	BVH bvh;
+	uint32_t bvhSphereCount;
+	std::vector<Plane> bvhPlanes;
+	bool isPicked;
+	RaycastHit pickedHit;
+};
+
+//最初のフレームの入力(ImGuiで触る前の値)
+FrameInput MakeInitialFrameInput();
+
+void InitializeApp(AppState &app , const FrameInput &input);
+
+//入力をシーンへ反映して、カメラ・当たり判定・マウスで選んだ物を更新する
+void UpdateApp(AppState &app , const FrameInput &input , RenderContext &renderContext);
+
+//描画に渡す1フレーム分のカメラとシーン(作った後は書き換えない)
+//更新と描画を並列に回す時は、描画スレッドがこれだけを読む
+struct FrameSnapshot {
+	RenderContext renderContext; //lineSinkは使わない
+	SphereArray spheres;
+	std::vector<uint32_t> sphereColors;
+	std::vector<Plane> planes;
+	std::vector<uint32_t> planeColors;
+	std::vector<SphereInstance> debugSpheres;
+};
+
+//更新が終わった状態をスナップショットに写す(配列は前のフレームの確保を使い回す)
+void WriteSnapshot(const AppState &app , const RenderContext &renderContext , FrameSnapshot &snapshot);
+
+//スナップショットのグリッドとシーンを線にする。戻り値は描いた数
+//描画スレッドから呼ぶので、カウンタはProfilerではなくcountersに数える
+uint32_t DrawSnapshot(const FrameSnapshot &snapshot , JobSystem &jobSystem , const SceneFile &sceneFile , LineBatch &lineBatch , ProfileCounterBlock &counters);
+
+//描き終わった1フレーム分の線
+struct RenderedFrame {
+	LineBatch *lines;
+	uint32_t drawnCount;
+	uint32_t objectCount;
+	float geometryMilliseconds;
+	uint64_t frame; //線にしたスナップショットのフレーム番号(latencyが1なら今のフレームの1つ前)
+	uint64_t counters[kProfileCounterCount]; //線にする間に数えたカウンタ(geometryMillisecondsと一緒にメインスレッドでProfilerに足す)
+};
+
+//更新と描画をずらして並列に回す
+//メインスレッドがフレームNのスナップショットを渡すと描画スレッドが線にし、その間にメインスレッドはN-1の線を送ってN+1を更新する
+//スナップショットと線は2つずつ持ち、受け渡しはロックを使わずatomicのフレーム番号で行う
+//Noviceはメインスレッドからしか呼べないので、線を送るのはメインスレッドのまま
+class RenderPipeline {
+public:
+	//latencyが0ならその場で描く(今まで通り)、1なら1フレーム遅れて出る
+	RenderPipeline(JobSystem &jobSystem , const SceneFile &sceneFile , uint32_t latency)
+		: jobSystem_(jobSystem) , sceneFile_(sceneFile) , latency_(latency > 0 ? 1 : 0) {
+		if (latency_ > 0) {
+			thread_ = std::thread([this] { RenderLoop(); });
+		}
+	}
+
+	~RenderPipeline() {
+		if (thread_.joinable()) {
+			isStopping_.store(true , std::memory_order_release);
+			publishedCount_.fetch_add(1 , std::memory_order_release);
+			publishedCount_.notify_one();
+			thread_.join();
+		}
+	}
+
+	RenderPipeline(const RenderPipeline &) = delete;
+	RenderPipeline &operator=(const RenderPipeline &) = delete;
+
+	//今のフレームで書くスナップショット(2フレーム前の物で、もう描き終わっている)
+	FrameSnapshot &GetWritableSnapshot() { return slots_[submittedCount_ % 2].snapshot; }
+
+	//書いたスナップショットを渡して、送る線を受け取る
+	//受け取った線は次にSubmitを呼ぶまでに送って空にする
+	//送る線が無ければ(最初のフレーム)戻り値のlinesがnullptr
+	RenderedFrame Submit() {
+		uint64_t frame = submittedCount_++;
+		if (latency_ == 0) {
+			Render(frame);
+			return slots_[frame % 2].result;
+		}
+
+		publishedCount_.store(frame + 1 , std::memory_order_release);
+		publishedCount_.notify_one();
+		if (frame == 0) {
+			return {nullptr, 0, 0, 0.0f, 0, {}};
+		}
+		return WaitFor(frame - 1);
+	}
+
+	//渡したのにまだ受け取っていない最後のフレームを待って受け取る(終わる時用)
+	RenderedFrame Drain() {
+		if (latency_ == 0 || submittedCount_ == 0 || isDrained_) {
+			return {nullptr, 0, 0, 0.0f, 0, {}};
+		}
+		isDrained_ = true;
+		return WaitFor(submittedCount_ - 1);
+	}
+
+private:
+	struct Slot {
+		FrameSnapshot snapshot;
+		LineBatch lines;
+		ProfileCounterBlock counters;
+		RenderedFrame result;
+	};
+
+	void Render(uint64_t frame) {
+		Slot &slot = slots_[frame % 2];
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		uint32_t drawnCount = DrawSnapshot(slot.snapshot , jobSystem_ , sceneFile_ , slot.lines , slot.counters);
+		std::chrono::duration<float , std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		slot.result.lines = &slot.lines;
+		slot.result.drawnCount = drawnCount;
+		slot.result.objectCount = uint32_t(slot.snapshot.spheres.size() + slot.snapshot.planes.size() + slot.snapshot.debugSpheres.size()) + sceneFile_.GetSphereCount() + sceneFile_.GetPlaneCount();
+		slot.result.geometryMilliseconds = elapsed.count();
+		slot.result.frame = frame;
+		for (int i = 0; i < kProfileCounterCount; ++i) {
+			slot.result.counters[i] = slot.counters.values[i].exchange(0 , std::memory_order_relaxed);
+		}
+	}
+
+	void RenderLoop() {
+		for (uint64_t frame = 0;; ++frame) {
+			//frameが渡されるまで待つ
+			uint64_t published = publishedCount_.load(std::memory_order_acquire);
+			while (published <= frame) {
+				publishedCount_.wait(published , std::memory_order_acquire);
+				published = publishedCount_.load(std::memory_order_acquire);
+			}
+			if (isStopping_.load(std::memory_order_acquire)) {
+				return;
+			}
+
+			Render(frame);
+			completedCount_.store(frame + 1 , std::memory_order_release);
+			completedCount_.notify_one();
+		}
+	}
+
+	RenderedFrame WaitFor(uint64_t frame) {
+		uint64_t completed = completedCount_.load(std::memory_order_acquire);
+		while (completed <= frame) {
+			completedCount_.wait(completed , std::memory_order_acquire);
+			completed = completedCount_.load(std::memory_order_acquire);
+		}
+		return slots_[frame % 2].result;
+	}
+
+	JobSystem &jobSystem_;
+	const SceneFile &sceneFile_;
+	uint32_t latency_;
+	Slot slots_[2];
+	uint64_t submittedCount_ = 0; //メインスレッドだけが触る
+	bool isDrained_ = false;
+	std::atomic<uint64_t> publishedCount_ = 0; //渡したフレーム数
+	std::atomic<uint64_t> completedCount_ = 0; //描き終わったフレーム数
+	std::atomic<bool> isStopping_ = false;
+	std::thread thread_;
+};
+
+//コマンドラインで選ぶ動かし方
+enum RunMode {
+	kRunWindow , //ウィンドウを出す(WinMainだけ)
+	kRunHeadless ,
+	kRunReplay
+};
+
+//コマンドラインの設定(WinMainとLinuxのmainで共通)
+struct CommandLineOptions {
+	RunMode mode = kRunWindow;
+	std::string scenePath;
+	std::string recordPath;
+	uint32_t latency = 1;
+	bool isDeduplicateLines = false; //-dedup
+	int frameCount = 1; //-headless
+	std::string inputPath; //-replay
+	std::string outputPath;
+	std::string csvPath;
+};
+
+//"-scene ファイル" なら保存したシーンを読んで一緒に描く(-headless , -replayより前に書く)
+//"-latency 0|1" は更新と描画を並列に回すか(1なら描画が1フレーム遅れる。-replayより前に書く)
+//"-record ファイル" ならフレームごとの入力を記録する(ウィンドウの時だけ)
+//"-dedup" なら描き終わった線から同じ線を消す(描画スレッドで。-headless , -replayより前に書く)
+//"-headless フレーム数 [出力.ppm] [計測.csv]" ならウィンドウを出さずに回す
+//"-replay ファイル [計測.csv] [出力.ppm]" なら記録した入力をウィンドウを出さずに流し直す
+CommandLineOptions ParseCommandLine(std::istream &commandLine);
+
+//-headless か -replay を実行する。戻り値はプロセスの終了コード
+int RunWithoutWindow(const CommandLineOptions &options);
+
+//ウィンドウ無しで決まったフレーム数だけ回す(プロファイル・回帰テスト用)
+//最後のフレームをPPMで、フレームごとの計測をCSVで保存する
+//scenePathがあればシーンファイルも一緒に描く
+int RunHeadless(int frameCount , const std::string &outputPath , const std::string &csvPath , const std::string &scenePath , bool isDeduplicateLines);
+
+//記録した入力をウィンドウ無しで、フレームレートの上限無しで流し直す
+//フレームごとの時間と出した線のチェックサムをCSVに、最後のチェックサムを標準出力に書く
+//同じ記録で最適化の前後を比べれば、速さと出力が変わっていないかが分かる
+//latencyが1なら更新と描画を並列に回す(線は1フレーム遅れるが、全フレーム分のチェックサムは同じになる)
+//CSVの1行はframeの更新の時間と、snapshot_frameのスナップショットの線(geometry_ms , lines , checksum)なので、latencyが1だと1つずれる
+int RunReplay(const std::string &inputPath , const std::string &csvPath , const std::string &outputPath , const std::string &scenePath , uint32_t latency , bool isDeduplicateLines);
@@ -0,0 +1,480 @@
+#include "BVH.h"
+#include <algorithm>
+#include <assert.h>
+#include <cfloat>
+
+namespace {
+
+float GetSurfaceArea(const float (&min)[3] , const float (&max)[3]) {
+	float x = max[0] - min[0];
+	float y = max[1] - min[1];
+	float z = max[2] - min[2];
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+void ResetBounds(float (&min)[3] , float (&max)[3]) {
+	for (int axis = 0; axis < 3; ++axis) {
+		min[axis] = FLT_MAX;
+		max[axis] = -FLT_MAX;
+	}
+}
+
+void GrowBounds(float (&min)[3] , float (&max)[3] , const float (&otherMin)[3] , const float (&otherMax)[3]) {
+	for (int axis = 0; axis < 3; ++axis) {
+		min[axis] = std::min(min[axis] , otherMin[axis]);
+		max[axis] = std::max(max[axis] , otherMax[axis]);
+	}
+}
+
+void GetSphereBounds(const Sphere &sphere , float (&min)[3] , float (&max)[3]) {
+	min[0] = sphere.center.x - sphere.radius;
+	min[1] = sphere.center.y - sphere.radius;
+	min[2] = sphere.center.z - sphere.radius;
+	max[0] = sphere.center.x + sphere.radius;
+	max[1] = sphere.center.y + sphere.radius;
+	max[2] = sphere.center.z + sphere.radius;
+}
+
+//箱とレイ(スラブ法)。当たれば入った所のtを返す
+bool IntersectRayBox(const float (&min)[3] , const float (&max)[3] , const Vec3 &origin , const Vec3 &invDirection , float maxT , float &entryT) {
+	float t1 = (min[0] - origin.x) * invDirection.x;
+	float t2 = (max[0] - origin.x) * invDirection.x;
+	float tMin = std::min(t1 , t2);
+	float tMax = std::max(t1 , t2);
+	t1 = (min[1] - origin.y) * invDirection.y;
+	t2 = (max[1] - origin.y) * invDirection.y;
+	tMin = std::max(tMin , std::min(t1 , t2));
+	tMax = std::min(tMax , std::max(t1 , t2));
+	t1 = (min[2] - origin.z) * invDirection.z;
+	t2 = (max[2] - origin.z) * invDirection.z;
+	tMin = std::max(tMin , std::min(t1 , t2));
+	tMax = std::min(tMax , std::max(t1 , t2));
+
+	entryT = std::max(tMin , 0.0f);
+	return tMax >= entryT && entryT <= maxT;
+}
+
+//箱と球(箱の中の一番近い点までの距離)
+bool IsSphereToBoxCollision(const Sphere &sphere , const float (&min)[3] , const float (&max)[3]) {
+	float center[3] = {sphere.center.x, sphere.center.y, sphere.center.z};
+	float lengthSq = 0.0f;
+	for (int axis = 0; axis < 3; ++axis) {
+		float v = std::clamp(center[axis] , min[axis] , max[axis]) - center[axis];
+		lengthSq += v * v;
+	}
+	return lengthSq <= sphere.radius * sphere.radius;
+}
+
+enum BoxFrustumResult {
+	kBoxOutside ,
+	kBoxIntersect ,
+	kBoxInside
+};
+
+BoxFrustumResult TestBoxToFrustum(const Frustum &frustum , const float (&min)[3] , const float (&max)[3]) {
+	BoxFrustumResult result = kBoxInside;
+	for (int i = 0; i < kFrustumPlaneCount; ++i) {
+		const Plane &plane = frustum.planes[i];
+		//法線の向きで一番内側の角と一番外側の角
+		Vec3 positive = {
+			plane.normal.x >= 0.0f ? max[0] : min[0],
+			plane.normal.y >= 0.0f ? max[1] : min[1],
+			plane.normal.z >= 0.0f ? max[2] : min[2]
+		};
+		if (SignedDistance(positive , plane) < 0.0f) {
+			return kBoxOutside;
+		}
+		Vec3 negative = {
+			plane.normal.x >= 0.0f ? min[0] : max[0],
+			plane.normal.y >= 0.0f ? min[1] : max[1],
+			plane.normal.z >= 0.0f ? min[2] : max[2]
+		};
+		if (SignedDistance(negative , plane) < 0.0f) {
+			result = kBoxIntersect;
+		}
+	}
+	return result;
+}
+
+//SAHで分けるのはこの深さまで。これより深い所は中心の並びで数を半分にする
+//球の数はuint32_tなので、木の深さは 32 + log2(2^32 / 4) = 62 までになる
+const uint32_t kMaxSAHDepth = 32;
+
+//探索用のスタックの深さ(下りるたびに兄弟を1つ積むので、木の深さ + 2 あれば足りる)
+const int kStackSize = 64;
+
+} // namespace
+
+void BVH::Build(const float *x , const float *y , const float *z , const float *radius , size_t count) {
+	std::vector<BuildItem> items(count);
+	for (size_t i = 0; i < count; ++i) {
+		BuildItem &item = items[i];
+		GetSphereBounds({{x[i], y[i], z[i]}, radius[i]} , item.min , item.max);
+		item.centroid[0] = x[i];
+		item.centroid[1] = y[i];
+		item.centroid[2] = z[i];
+		item.id = uint32_t(i);
+	}
+
+	nodes_.clear();
+	nodes_.reserve(count * 2);
+	if (count > 0) {
+		BuildNode(items , 0 , uint32_t(count) , 0);
+	}
+
+	//葉の順に球を並べ直しておくと、葉の中の判定が連続したメモリになる
+	spheres_.resize(count);
+	ids_.resize(count);
+	idToIndex_.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t id = items[i].id;
+		spheres_[i] = {{x[id], y[id], z[id]}, radius[id]};
+		ids_[i] = id;
+		idToIndex_[id] = uint32_t(i);
+	}
+}
+
+void BVH::Build(const SphereArray &spheres) {
+	Build(spheres.x.data() , spheres.y.data() , spheres.z.data() , spheres.radius.data() , spheres.size());
+}
+
+uint32_t BVH::BuildNode(std::vector<BuildItem> &items , uint32_t begin , uint32_t end , uint32_t depth) {
+	uint32_t nodeIndex = uint32_t(nodes_.size());
+	nodes_.push_back({});
+
+	float min[3];
+	float max[3];
+	float centroidMin[3];
+	float centroidMax[3];
+	ResetBounds(min , max);
+	ResetBounds(centroidMin , centroidMax);
+	for (uint32_t i = begin; i < end; ++i) {
+		GrowBounds(min , max , items[i].min , items[i].max);
+		GrowBounds(centroidMin , centroidMax , items[i].centroid , items[i].centroid);
+	}
+
+	uint32_t count = end - begin;
+	auto makeLeaf = [&]() {
+		Node &node = nodes_[nodeIndex];
+		std::copy(min , min + 3 , node.min);
+		std::copy(max , max + 3 , node.max);
+		node.offset = begin;
+		node.count = count;
+		return nodeIndex;
+	};
+	if (count <= kMaxLeafCount) {
+		return makeLeaf();
+	}
+
+	auto makeInner = [&](uint32_t middle) {
+		BuildNode(items , begin , middle , depth + 1);
+		uint32_t right = BuildNode(items , middle , end , depth + 1);
+
+		Node &node = nodes_[nodeIndex];
+		std::copy(min , min + 3 , node.min);
+		std::copy(max , max + 3 , node.max);
+		node.offset = right;
+		node.count = 0;
+		return nodeIndex;
+	};
+
+	//深すぎる所(SAHが端の数個ずつしか切り離さない並び)は、中心が一番広がっている軸の真ん中で数を半分にする
+	if (depth >= kMaxSAHDepth) {
+		int axis = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (centroidMax[i] - centroidMin[i] > centroidMax[axis] - centroidMin[axis]) {
+				axis = i;
+			}
+		}
+		uint32_t middle = begin + count / 2;
+		std::nth_element(items.begin() + begin , items.begin() + middle , items.begin() + end , [&](const BuildItem &a , const BuildItem &b) {
+			return a.centroid[axis] < b.centroid[axis];
+		});
+		return makeInner(middle);
+	}
+
+	//中心の位置でbinに分けて、一番コストの低い境目を探す
+	//コスト = 箱を調べる1 + (左の数 * 左の面積 + 右の数 * 右の面積) / 親の面積
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	uint32_t bestSplit = 0;
+	for (int axis = 0; axis < 3; ++axis) {
+		float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.0f) {
+			continue;
+		}
+		float scale = float(kBinCount) / extent;
+
+		uint32_t binCounts[kBinCount] = {};
+		float binMin[kBinCount][3];
+		float binMax[kBinCount][3];
+		for (uint32_t bin = 0; bin < kBinCount; ++bin) {
+			ResetBounds(binMin[bin] , binMax[bin]);
+		}
+		for (uint32_t i = begin; i < end; ++i) {
+			uint32_t bin = std::min(uint32_t((items[i].centroid[axis] - centroidMin[axis]) * scale) , kBinCount - 1);
+			++binCounts[bin];
+			GrowBounds(binMin[bin] , binMax[bin] , items[i].min , items[i].max);
+		}
+
+		//右から累積した面積と数
+		float rightArea[kBinCount];
+		uint32_t rightCount[kBinCount];
+		float sweepMin[3];
+		float sweepMax[3];
+		ResetBounds(sweepMin , sweepMax);
+		uint32_t sweepCount = 0;
+		for (uint32_t bin = kBinCount - 1; bin > 0; --bin) {
+			GrowBounds(sweepMin , sweepMax , binMin[bin] , binMax[bin]);
+			sweepCount += binCounts[bin];
+			rightArea[bin] = sweepCount > 0 ? GetSurfaceArea(sweepMin , sweepMax) : 0.0f;
+			rightCount[bin] = sweepCount;
+		}
+
+		ResetBounds(sweepMin , sweepMax);
+		sweepCount = 0;
+		for (uint32_t split = 1; split < kBinCount; ++split) {
+			GrowBounds(sweepMin , sweepMax , binMin[split - 1] , binMax[split - 1]);
+			sweepCount += binCounts[split - 1];
+			if (sweepCount == 0 || rightCount[split] == 0) {
+				continue;
+			}
+			float cost = float(sweepCount) * GetSurfaceArea(sweepMin , sweepMax) + float(rightCount[split]) * rightArea[split];
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	uint32_t middle = begin;
+	if (bestAxis >= 0) {
+		float parentArea = GetSurfaceArea(min , max);
+		if (parentArea > 0.0f && 1.0f + bestCost / parentArea >= float(count)) {
+			//分けても得をしない
+			return makeLeaf();
+		}
+		float scale = float(kBinCount) / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+		auto isLeft = [&](const BuildItem &item) {
+			return std::min(uint32_t((item.centroid[bestAxis] - centroidMin[bestAxis]) * scale) , kBinCount - 1) < bestSplit;
+		};
+		middle = uint32_t(std::partition(items.begin() + begin , items.begin() + end , isLeft) - items.begin());
+	}
+	if (middle == begin || middle == end) {
+		//中心が全部同じ所にある時は数で半分にする
+		middle = begin + count / 2;
+	}
+
+	return makeInner(middle);
+}
+
+void BVH::UpdateLeafBounds(Node &node) const {
+	ResetBounds(node.min , node.max);
+	for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+		float min[3];
+		float max[3];
+		GetSphereBounds(spheres_[i] , min , max);
+		GrowBounds(node.min , node.max , min , max);
+	}
+}
+
+void BVH::Refit(const float *x , const float *y , const float *z , const float *radius) {
+	for (size_t i = 0; i < spheres_.size(); ++i) {
+		uint32_t id = ids_[i];
+		spheres_[i] = {{x[id], y[id], z[id]}, radius[id]};
+	}
+
+	//子は必ず親より後ろにあるので、後ろから更新すれば子が先に終わっている
+	for (size_t i = nodes_.size(); i-- > 0;) {
+		Node &node = nodes_[i];
+		if (node.count > 0) {
+			UpdateLeafBounds(node);
+		} else {
+			const Node &left = nodes_[i + 1];
+			const Node &right = nodes_[node.offset];
+			ResetBounds(node.min , node.max);
+			GrowBounds(node.min , node.max , left.min , left.max);
+			GrowBounds(node.min , node.max , right.min , right.max);
+		}
+	}
+}
+
+void BVH::Refit(const SphereArray &spheres) {
+	assert(spheres.size() == spheres_.size());
+	Refit(spheres.x.data() , spheres.y.data() , spheres.z.data() , spheres.radius.data());
+}
+
+void BVH::SetPlanes(const Plane *planes , size_t count) {
+	planes_.assign(planes , planes + count);
+}
+
+template<typename LeafFunc>
+void BVH::Traverse(const Ray &ray , float &maxT , LeafFunc leaf) const {
+	if (nodes_.empty()) {
+		return;
+	}
+	//0で割るとinfになり、その軸はスラブ判定で常に通る
+	Vec3 invDirection = {1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z};
+
+	uint32_t stack[kStackSize];
+	int stackCount = 0;
+	float entryT;
+	if (!IntersectRayBox(nodes_[0].min , nodes_[0].max , ray.origin , invDirection , maxT , entryT)) {
+		return;
+	}
+	stack[stackCount++] = 0;
+
+	while (stackCount > 0) {
+		const Node &node = nodes_[stack[--stackCount]];
+		if (node.count > 0) {
+			if (leaf(node.offset , node.count)) {
+				return;
+			}
+			continue;
+		}
+
+		//近い方の子から調べると、maxTが早く縮んで奥の箱を飛ばせる
+		uint32_t leftIndex = uint32_t(&node - nodes_.data()) + 1;
+		uint32_t rightIndex = node.offset;
+		float leftT;
+		float rightT;
+		bool isLeftHit = IntersectRayBox(nodes_[leftIndex].min , nodes_[leftIndex].max , ray.origin , invDirection , maxT , leftT);
+		bool isRightHit = IntersectRayBox(nodes_[rightIndex].min , nodes_[rightIndex].max , ray.origin , invDirection , maxT , rightT);
+		assert(stackCount + 2 <= kStackSize);
+		if (isLeftHit && isRightHit) {
+			if (leftT <= rightT) {
+				stack[stackCount++] = rightIndex;
+				stack[stackCount++] = leftIndex;
+			} else {
+				stack[stackCount++] = leftIndex;
+				stack[stackCount++] = rightIndex;
+			}
+		} else if (isLeftHit) {
+			stack[stackCount++] = leftIndex;
+		} else if (isRightHit) {
+			stack[stackCount++] = rightIndex;
+		}
+	}
+}
+
+bool BVH::Raycast(const Ray &ray , float maxT , RaycastHit &hit) const {
+	bool isHit = false;
+	for (size_t i = 0; i < planes_.size(); ++i) {
+		float t;
+		if (RaycastPlane(ray , planes_[i] , maxT , t)) {
+			maxT = t;
+			hit = {t, uint32_t(i), true};
+			isHit = true;
+		}
+	}
+
+	Traverse(ray , maxT , [&](uint32_t first , uint32_t count) {
+		for (uint32_t i = first; i < first + count; ++i) {
+			float t;
+			if (RaycastSphere(ray , spheres_[i] , maxT , t)) {
+				maxT = t;
+				hit = {t, ids_[i], false};
+				isHit = true;
+			}
+		}
+		return false;
+	});
+	return isHit;
+}
+
+bool BVH::IsOccluded(const Ray &ray , float maxT) const {
+	for (const Plane &plane : planes_) {
+		float t;
+		if (RaycastPlane(ray , plane , maxT , t)) {
+			return true;
+		}
+	}
+
+	bool isOccluded = false;
+	Traverse(ray , maxT , [&](uint32_t first , uint32_t count) {
+		for (uint32_t i = first; i < first + count; ++i) {
+			float t;
+			if (RaycastSphere(ray , spheres_[i] , maxT , t)) {
+				isOccluded = true;
+				return true;
+			}
+		}
+		return false;
+	});
+	return isOccluded;
+}
+
+void BVH::QuerySphere(const Sphere &sphere , std::vector<uint32_t> &sphereIds , std::vector<uint32_t> &planeIds) const {
+	sphereIds.clear();
+	planeIds.clear();
+	for (size_t i = 0; i < planes_.size(); ++i) {
+		if (IsSphereToPlaneCollision(sphere , planes_[i])) {
+			planeIds.push_back(uint32_t(i));
+		}
+	}
+	if (nodes_.empty()) {
+		return;
+	}
+
+	uint32_t stack[kStackSize];
+	int stackCount = 0;
+	stack[stackCount++] = 0;
+	while (stackCount > 0) {
+		uint32_t nodeIndex = stack[--stackCount];
+		const Node &node = nodes_[nodeIndex];
+		if (!IsSphereToBoxCollision(sphere , node.min , node.max)) {
+			continue;
+		}
+		if (node.count > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				if (IsCollision(sphere , spheres_[i])) {
+					sphereIds.push_back(ids_[i]);
+				}
+			}
+			continue;
+		}
+		assert(stackCount + 2 <= kStackSize);
+		stack[stackCount++] = node.offset;
+		stack[stackCount++] = nodeIndex + 1;
+	}
+}
+
+void BVH::QueryFrustum(const Frustum &frustum , std::vector<uint32_t> &sphereIds) const {
+	sphereIds.clear();
+	if (nodes_.empty()) {
+		return;
+	}
+
+	//isInside: 親の箱が視錐台に完全に入っていれば子は調べずに全部入れる
+	struct StackItem {
+		uint32_t nodeIndex;
+		bool isInside;
+	};
+	StackItem stack[kStackSize];
+	int stackCount = 0;
+	stack[stackCount++] = {0, false};
+	while (stackCount > 0) {
+		StackItem item = stack[--stackCount];
+		const Node &node = nodes_[item.nodeIndex];
+		bool isInside = item.isInside;
+		if (!isInside) {
+			BoxFrustumResult result = TestBoxToFrustum(frustum , node.min , node.max);
+			if (result == kBoxOutside) {
+				continue;
+			}
+			isInside = result == kBoxInside;
+		}
+		if (node.count > 0) {
+			for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				if (isInside || IsSphereInFrustum(spheres_[i] , frustum)) {
+					sphereIds.push_back(ids_[i]);
+				}
+			}
+			continue;
+		}
+		assert(stackCount + 2 <= kStackSize);
+		stack[stackCount++] = {node.offset, isInside};
+		stack[stackCount++] = {item.nodeIndex + 1, isInside};
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Collision.h"
+#include "MyMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//BVHのレイキャストの結果
+struct RaycastHit {
+	float t; //origin + direction * t が当たった所
+	uint32_t id; //Buildに渡した球、SetPlanesに渡した平面の番号
+	bool isPlane;
+};
+
+//球のBVH(SAHで分割、深さ優先で1本の配列に並べる)
+//平面は無限に広がって箱に入らないので、BVHに入れず別のリストで全部調べる
+class BVH {
+public:
+	//球から作り直す(SoAで渡す)
+	void Build(const float *x , const float *y , const float *z , const float *radius , size_t count);
+	void Build(const SphereArray &spheres);
+
+	//木の形はそのままで箱だけ更新する(球の数と並び順はBuildの時と同じであること)
+	//少し動いただけなら作り直すより速い。大きく動いた後はBuildし直した方が探索が速くなる
+	void Refit(const float *x , const float *y , const float *z , const float *radius);
+	void Refit(const SphereArray &spheres);
+
+	void SetPlanes(const Plane *planes , size_t count);
+
+	//一番手前に当たった物を返す(0 <= t <= maxT)
+	bool Raycast(const Ray &ray , float maxT , RaycastHit &hit) const;
+
+	//どれかに当たればtrue(一番手前は探さないので見通しの判定に使う)
+	bool IsOccluded(const Ray &ray , float maxT) const;
+
+	//球と重なっている球と平面の番号を集める
+	void QuerySphere(const Sphere &sphere , std::vector<uint32_t> &sphereIds , std::vector<uint32_t> &planeIds) const;
+
+	//視錐台に入っている球の番号を集める(平面は全部見えている扱いなので含めない)
+	void QueryFrustum(const Frustum &frustum , std::vector<uint32_t> &sphereIds) const;
+
+	size_t GetNodeCount() const { return nodes_.size(); }
+
+private:
+	//32byteで2つがキャッシュラインに収まる
+	//子は深さ優先で並べるので、左の子は常に自分の次。count == 0 なら offset は右の子
+	//葉なら offset から count 個が spheres_ の範囲
+	struct Node {
+		float min[3];
+		uint32_t offset;
+		float max[3];
+		uint32_t count;
+	};
+
+	//作る途中の球の情報
+	struct BuildItem {
+		float min[3];
+		float max[3];
+		float centroid[3];
+		uint32_t id;
+	};
+
+	static const uint32_t kMaxLeafCount = 4;
+	static const uint32_t kBinCount = 12;
+
+	uint32_t BuildNode(std::vector<BuildItem> &items , uint32_t begin , uint32_t end , uint32_t depth);
+	void UpdateLeafBounds(Node &node) const;
+
+	template<typename LeafFunc>
+	void Traverse(const Ray &ray , float &maxT , LeafFunc leaf) const;
+
+	std::vector<Node> nodes_;
+	std::vector<Sphere> spheres_; //葉の順に並べたコピー
+	std::vector<uint32_t> ids_; //spheres_[i] の元の番号
+	std::vector<uint32_t> idToIndex_; //元の番号から spheres_ の位置(Refit用)
+	std::vector<Plane> planes_;
+};
@@ -0,0 +1,187 @@
+//BVHの探索結果を全部調べた結果と比べる(CMakeLists.txtのctest)
+//普通のランダムな球と、SAHで分けると片寄った深い木になる並び(探索のスタックがあふれないか)の両方で確かめる
+#include "BVH.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+//raycastのtは計算の順番で最後の数桁が変わる
+const float kRaycastTolerance = 1.0e-4f;
+
+//戻り値は合わなかった数
+int CompareIds(const char *name , std::vector<uint32_t> actual , std::vector<uint32_t> expected) {
+	std::sort(actual.begin() , actual.end());
+	std::sort(expected.begin() , expected.end());
+	if (actual == expected) {
+		return 0;
+	}
+	std::fprintf(stderr , "%s: expected %zu ids , actual %zu ids\n" , name , expected.size() , actual.size());
+	return 1;
+}
+
+int CheckQuerySphere(const char *name , const BVH &bvh , const SphereArray &spheres , const std::vector<Plane> &planes , const Sphere &query) {
+	std::vector<uint32_t> sphereIds;
+	std::vector<uint32_t> planeIds;
+	bvh.QuerySphere(query , sphereIds , planeIds);
+
+	std::vector<uint32_t> expectedSphereIds;
+	for (size_t i = 0; i < spheres.size(); ++i) {
+		if (IsCollision(query , {{spheres.x[i], spheres.y[i], spheres.z[i]}, spheres.radius[i]})) {
+			expectedSphereIds.push_back(uint32_t(i));
+		}
+	}
+	std::vector<uint32_t> expectedPlaneIds;
+	for (size_t i = 0; i < planes.size(); ++i) {
+		if (IsSphereToPlaneCollision(query , planes[i])) {
+			expectedPlaneIds.push_back(uint32_t(i));
+		}
+	}
+	return CompareIds(name , sphereIds , expectedSphereIds) + CompareIds(name , planeIds , expectedPlaneIds);
+}
+
+int CheckQueryFrustum(const char *name , const BVH &bvh , const SphereArray &spheres , const Frustum &frustum) {
+	std::vector<uint32_t> sphereIds;
+	bvh.QueryFrustum(frustum , sphereIds);
+
+	std::vector<uint32_t> expectedSphereIds;
+	for (size_t i = 0; i < spheres.size(); ++i) {
+		if (IsSphereInFrustum({{spheres.x[i], spheres.y[i], spheres.z[i]}, spheres.radius[i]} , frustum)) {
+			expectedSphereIds.push_back(uint32_t(i));
+		}
+	}
+	return CompareIds(name , sphereIds , expectedSphereIds);
+}
+
+int CheckRaycast(const char *name , const BVH &bvh , const SphereArray &spheres , const std::vector<Plane> &planes , const Ray &ray , float maxT) {
+	bool isExpectedHit = false;
+	float expectedT = maxT;
+	for (size_t i = 0; i < spheres.size(); ++i) {
+		float t;
+		if (RaycastSphere(ray , {{spheres.x[i], spheres.y[i], spheres.z[i]}, spheres.radius[i]} , expectedT , t)) {
+			expectedT = t;
+			isExpectedHit = true;
+		}
+	}
+	for (const Plane &plane : planes) {
+		float t;
+		if (RaycastPlane(ray , plane , expectedT , t)) {
+			expectedT = t;
+			isExpectedHit = true;
+		}
+	}
+
+	RaycastHit hit;
+	bool isHit = bvh.Raycast(ray , maxT , hit);
+	bool isOccluded = bvh.IsOccluded(ray , maxT);
+	if (isHit != isExpectedHit || isOccluded != isExpectedHit) {
+		std::fprintf(stderr , "%s: raycast hit %d occluded %d expected %d\n" , name , int(isHit) , int(isOccluded) , int(isExpectedHit));
+		return 1;
+	}
+	if (isHit && std::fabs(hit.t - expectedT) > kRaycastTolerance * std::fmax(1.0f , expectedT)) {
+		std::fprintf(stderr , "%s: raycast t expected %.9g actual %.9g\n" , name , expectedT , hit.t);
+		return 1;
+	}
+	return 0;
+}
+
+//全部の探索を1つの球の並びで確かめる
+//半径0の球は総当たりのRaycastSphereが丸め誤差で当たったり外れたりするので、isCheckRaycastをfalseにする
+int CheckAll(const char *name , const SphereArray &spheres , const std::vector<Plane> &planes , const std::vector<Sphere> &querySpheres , bool isCheckRaycast , std::mt19937 &random) {
+	BVH bvh;
+	bvh.Build(spheres);
+	bvh.SetPlanes(planes.data() , planes.size());
+
+	int failureCount = 0;
+	for (const Sphere &query : querySpheres) {
+		failureCount += CheckQuerySphere(name , bvh , spheres , planes , query);
+	}
+
+	std::uniform_real_distribution<float> angle(-3.14f , 3.14f);
+	std::uniform_real_distribution<float> position(-20.0f , 20.0f);
+	Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f , 1280.0f / 720.0f , 0.1f , 100.0f);
+	for (int i = 0; i < 20; ++i) {
+		Matrix4x4 camaraMatrix = MakeAffineMatrix({1.0f, 1.0f, 1.0f} , {angle(random) * 0.3f, angle(random), 0.0f} , {position(random), position(random), position(random)});
+		Frustum frustum = MakeFrustum(Multiply(Inverse(camaraMatrix) , projectionMatrix));
+		failureCount += CheckQueryFrustum(name , bvh , spheres , frustum);
+
+		Vec3 direction = Normalize({position(random), position(random), position(random)});
+		Ray ray = {{position(random), position(random), position(random)}, direction};
+		if (isCheckRaycast) {
+			failureCount += CheckRaycast(name , bvh , spheres , planes , ray , 100.0f);
+		}
+	}
+
+	//Buildし直さずに動かしても同じ結果になる
+	SphereArray moved = spheres;
+	for (size_t i = 0; i < moved.size(); ++i) {
+		moved.x[i] += 0.5f;
+	}
+	bvh.Refit(moved);
+	for (const Sphere &query : querySpheres) {
+		failureCount += CheckQuerySphere(name , bvh , moved , planes , query);
+	}
+	return failureCount;
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(20240611);
+	std::uniform_real_distribution<float> position(-20.0f , 20.0f);
+	std::uniform_real_distribution<float> radius(0.05f , 2.0f);
+
+	int failureCount = 0;
+
+	//ランダムな球
+	{
+		SphereArray spheres;
+		for (int i = 0; i < 3000; ++i) {
+			spheres.push_back({{position(random), position(random), position(random)}, radius(random)});
+		}
+		std::vector<Plane> planes = {{{0.0f, 1.0f, 0.0f}, -5.0f}, {Normalize({1.0f, 1.0f, 0.0f}), 3.0f}};
+		std::vector<Sphere> querySpheres;
+		for (int i = 0; i < 200; ++i) {
+			querySpheres.push_back({{position(random), position(random), position(random)}, radius(random) * 3.0f});
+		}
+		failureCount += CheckAll("random" , spheres , planes , querySpheres , true , random);
+	}
+
+	//全部同じ所にある球(中心で分けられない)
+	{
+		SphereArray spheres;
+		for (int i = 0; i < 500; ++i) {
+			spheres.push_back({{1.0f, 2.0f, 3.0f}, radius(random)});
+		}
+		failureCount += CheckAll("same center" , spheres , {} , {{{1.0f, 2.0f, 3.0f}, 0.1f}, {{5.0f, 2.0f, 3.0f}, 3.5f}} , true , random);
+	}
+
+	//指数的に離れていく半径0の球。SAHでは毎回端の数個だけを切り離すので、深さを制限しないと木が深くなりすぎて探索のスタックがあふれる
+	//(start * ratio^i をdoubleで計算してfloatにする。12.5倍ずつなら左の子が毎回ほとんど全部を持つ)
+	struct Geometric {
+		const char *name;
+		double start;
+		double ratio;
+		int count;
+	};
+	const Geometric kGeometrics[] = {
+		{"geometric 1.05" , 1.0e-36 , 1.05 , 2000} ,
+		{"geometric -1.05" , -1.0e-36 , 1.05 , 2000} ,
+		{"geometric 12.5" , 1.4e-45 , 12.5 , 76} ,
+		{"geometric -12.5" , -1.4e-45 , 12.5 , 76}
+	};
+	for (const Geometric &geometric : kGeometrics) {
+		SphereArray spheres;
+		for (int i = 0; i < geometric.count; ++i) {
+			spheres.push_back({{float(geometric.start * std::pow(geometric.ratio , double(i))), 0.0f, 0.0f}, 0.0f});
+		}
+		std::vector<Sphere> querySpheres = {{{0.0f, 0.0f, 0.0f}, 1.0e37f}, {{0.0f, 0.0f, 0.0f}, 1.0e-30f}, {{1.0f, 0.0f, 0.0f}, 1.0f}};
+		failureCount += CheckAll(geometric.name , spheres , {} , querySpheres , false , random);
+	}
+
+	std::printf("BVH: failures %d\n" , failureCount);
+	return failureCount == 0 ? 0 : 1;
+}
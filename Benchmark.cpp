@@ -0,0 +1,371 @@
+//数学ライブラリと描画のマイクロベンチマーク(Noviceなしでビルドする。CMakeLists.txtのbenchmark)
+//  cmake -S . -B build -DMT3_NATIVE=ON && cmake --build build
+//  ./build/benchmark [出力先.json]
+//結果はJSONで出すので、コミット間でdiffして比べる
+#include "MyMath.h"
+#include "Collision.h"
+#include "BVH.h"
+#include "LineBatch.h"
+#include "Render.h"
+#include "SceneFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//1回の計測はこの時間以上回す
+const double kMinSampleSeconds = 0.05;
+//計測を何回繰り返して中央値を取るか
+const int kSampleCount = 7;
+//L1に収まる量、L2に収まる量、収まらない量
+const size_t kBatchSizes[] = {64 , 1024 , 16384};
+
+struct BenchmarkResult {
+	std::string name;
+	size_t batchSize;
+	double nsPerOp;
+	double opsPerSecond;
+};
+
+//最適化で計算を消されないように結果をここに足す
+volatile float gSink = 0.0f;
+
+void Consume(float value) {
+	gSink = gSink + value;
+}
+
+void Consume(const Vec3 &v) {
+	Consume(v.x + v.y + v.z);
+}
+
+void Consume(const Matrix4x4 &m) {
+	Consume(m.m[0][0] + m.m[1][1] + m.m[2][2] + m.m[3][3] + m.m[3][0]);
+}
+
+void Consume(bool value) {
+	Consume(value ? 1.0f : 0.0f);
+}
+
+//batch(i)を0～batchSize-1まで回すのを1パスとして、何パスか回して1回あたりの時間を出す
+template<typename BatchFunc>
+BenchmarkResult Run(const char *name , size_t batchSize , BatchFunc batch) {
+	using Clock = std::chrono::steady_clock;
+
+	//キャッシュを温めて、1サンプルで回すパス数を決める
+	size_t passCount = 1;
+	for (;;) {
+		Clock::time_point start = Clock::now();
+		for (size_t pass = 0; pass < passCount; ++pass) {
+			batch();
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		if (seconds >= kMinSampleSeconds) {
+			break;
+		}
+		passCount *= 2;
+	}
+
+	std::vector<double> samples;
+	for (int sample = 0; sample < kSampleCount; ++sample) {
+		Clock::time_point start = Clock::now();
+		for (size_t pass = 0; pass < passCount; ++pass) {
+			batch();
+		}
+		double ns = std::chrono::duration<double , std::nano>(Clock::now() - start).count();
+		samples.push_back(ns / double(passCount * batchSize));
+	}
+	std::sort(samples.begin() , samples.end());
+
+	BenchmarkResult result;
+	result.name = name;
+	result.batchSize = batchSize;
+	result.nsPerOp = samples[samples.size() / 2];
+	result.opsPerSecond = 1.0e9 / result.nsPerOp;
+	return result;
+}
+
+//ランダムな入力
+struct Inputs {
+	std::vector<Vec3> vectors;
+	std::vector<Vec3> scales;
+	std::vector<Vec3> rotates;
+	std::vector<Matrix4x4> matrices;
+	std::vector<Sphere> spheres;
+	std::vector<Plane> planes;
+	std::vector<float> fovs;
+};
+
+Inputs MakeInputs(size_t count) {
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> position(-10.0f , 10.0f);
+	std::uniform_real_distribution<float> angle(-3.14f , 3.14f);
+	std::uniform_real_distribution<float> scale(0.5f , 2.0f);
+	std::uniform_real_distribution<float> radius(0.1f , 2.0f);
+
+	Inputs inputs;
+	for (size_t i = 0; i < count; ++i) {
+		Vec3 s = {scale(random), scale(random), scale(random)};
+		Vec3 r = {angle(random), angle(random), angle(random)};
+		Vec3 t = {position(random), position(random), position(random)};
+		inputs.vectors.push_back({position(random), position(random), position(random)});
+		inputs.scales.push_back(s);
+		inputs.rotates.push_back(r);
+		inputs.matrices.push_back(MakeAffineMatrix(s , r , t));
+		inputs.spheres.push_back({{position(random), position(random), position(random)}, radius(random)});
+		inputs.planes.push_back({Normalize({position(random), position(random), position(random)}), position(random)});
+		inputs.fovs.push_back(0.3f + scale(random) * 0.2f);
+	}
+	return inputs;
+}
+
+void WriteJSON(FILE *file , const std::vector<BenchmarkResult> &results) {
+	fprintf(file , "{\n  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult &result = results[i];
+		fprintf(file , "    {\"name\": \"%s\", \"batch_size\": %zu, \"ns_per_op\": %.3f, \"ops_per_second\": %.0f}%s\n" ,
+			result.name.c_str() , result.batchSize , result.nsPerOp , result.opsPerSecond , i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file , "  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc , char **argv) {
+	std::vector<BenchmarkResult> results;
+
+	for (size_t batchSize : kBatchSizes) {
+		const Inputs in = MakeInputs(batchSize);
+		std::vector<Matrix4x4> outMatrices(batchSize);
+		std::vector<Vec3> outVectors(batchSize);
+		std::vector<float> outFloats(batchSize);
+		std::vector<uint8_t> outBools(batchSize);
+
+		results.push_back(Run("Multiply" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = Multiply(in.matrices[i] , in.matrices[batchSize - 1 - i]);
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		//ビュー * 射影 のように左がアフィンと分かっている積
+		results.push_back(Run("Multiply<Affine,Projective>" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = Multiply(MakeTyped<AffineTag>(in.matrices[i]) , MakeTyped<ProjectiveTag>(in.matrices[batchSize - 1 - i])).m;
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		results.push_back(Run("Multiply<Affine,Affine>" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = Multiply(MakeTyped<AffineTag>(in.matrices[i]) , MakeTyped<AffineTag>(in.matrices[batchSize - 1 - i])).m;
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		results.push_back(Run("Inverse" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = Inverse(in.matrices[i]);
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		results.push_back(Run("Determinant" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outFloats[i] = Determinant(in.matrices[i]);
+			}
+		}));
+		Consume(outFloats[batchSize / 2]);
+
+		results.push_back(Run("Transform" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outVectors[i] = Transform(in.vectors[i] , in.matrices[i]);
+			}
+		}));
+		Consume(outVectors[batchSize / 2]);
+
+		results.push_back(Run("Transform<Affine>" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outVectors[i] = Transform(in.vectors[i] , MakeTyped<AffineTag>(in.matrices[i]));
+			}
+		}));
+		Consume(outVectors[batchSize / 2]);
+
+		//SoAの頂点をまとめて。行列をかけ直すのと、かけておいた頂点を拡大+平行移動するだけのを比べる
+		Vec3Array vertices;
+		for (size_t i = 0; i < batchSize; ++i) {
+			vertices.push_back(in.vectors[i]);
+		}
+		Vec3Array outVertices;
+		results.push_back(Run("TransformBatch" , batchSize , [&]() {
+			TransformBatch(vertices , in.matrices[0] , outVertices);
+		}));
+		Consume(outVertices.x[batchSize / 2]);
+
+		std::vector<float> outX(batchSize);
+		std::vector<float> outY(batchSize);
+		const Vec4 offset = {1.0f, 2.0f, 3.0f, 40.0f};
+		results.push_back(Run("ProjectScaledBatch" , batchSize , [&]() {
+			ProjectScaledBatch(vertices.x.data() , vertices.y.data() , vertices.z.data() , batchSize , 0.5f , offset , outX.data() , outY.data());
+		}));
+		Consume(outX[batchSize / 2] + outY[batchSize / 2]);
+
+		results.push_back(Run("MakeAffineMatrix" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = MakeAffineMatrix(in.scales[i] , in.rotates[i] , in.vectors[i]);
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		results.push_back(Run("MakePerspectiveFovMatrix" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outMatrices[i] = MakePerspectiveFovMatrix(in.fovs[i] , 1280.0f / 720.0f , 0.1f , 100.0f);
+			}
+		}));
+		Consume(outMatrices[batchSize / 2]);
+
+		results.push_back(Run("IsCollision" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outBools[i] = IsCollision(in.spheres[i] , in.spheres[batchSize - 1 - i]);
+			}
+		}));
+		Consume(outBools[batchSize / 2] != 0);
+
+		results.push_back(Run("IsSphereToPlaneCollision" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				outBools[i] = IsSphereToPlaneCollision(in.spheres[i] , in.planes[i]);
+			}
+		}));
+		Consume(outBools[batchSize / 2] != 0);
+
+		results.push_back(Run("SweepSphereToPlane" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				SweepHit hit;
+				outBools[i] = SweepSphereToPlane(in.spheres[i] , in.vectors[i] , in.planes[i] , hit);
+			}
+		}));
+		Consume(outBools[batchSize / 2] != 0);
+
+		results.push_back(Run("SweepSphereToSphere" , batchSize , [&]() {
+			for (size_t i = 0; i < batchSize; ++i) {
+				SweepHit hit;
+				size_t other = batchSize - 1 - i;
+				outBools[i] = SweepSphereToSphere(in.spheres[i] , in.vectors[i] , in.spheres[other] , in.spheres[other].center , hit);
+			}
+		}));
+		Consume(outBools[batchSize / 2] != 0);
+
+		//同じ平面に対してSoAでまとめて
+		SphereArray starts;
+		Vec3Array ends;
+		for (size_t i = 0; i < batchSize; ++i) {
+			starts.push_back(in.spheres[i]);
+			ends.push_back(in.vectors[i]);
+		}
+		std::vector<float> times;
+		std::vector<uint64_t> hitMask;
+		results.push_back(Run("SweepSpheresToPlane" , batchSize , [&]() {
+			SweepSpheresToPlane(starts , ends , in.planes[0] , times , hitMask);
+		}));
+		Consume(times[batchSize / 2]);
+	}
+
+	{
+		//5万個の球のBVHに対するレイ(batch_sizeはレイの本数)
+		const size_t kObjectCount = 50000;
+		const size_t kRayCount = 1024;
+		std::mt19937 random(6789);
+		std::uniform_real_distribution<float> position(-100.0f , 100.0f);
+		std::uniform_real_distribution<float> radius(0.1f , 1.5f);
+		std::uniform_real_distribution<float> direction(-1.0f , 1.0f);
+		SphereArray spheres;
+		for (size_t i = 0; i < kObjectCount; ++i) {
+			spheres.push_back({{position(random), position(random), position(random)}, radius(random)});
+		}
+		std::vector<Ray> rays;
+		for (size_t i = 0; i < kRayCount; ++i) {
+			rays.push_back({{position(random), position(random), position(random)}, {direction(random), direction(random), direction(random)}});
+		}
+
+		BVH bvh;
+		results.push_back(Run("BVH::Build(50000)" , 1 , [&]() {
+			bvh.Build(spheres);
+		}));
+		results.push_back(Run("BVH::Refit(50000)" , 1 , [&]() {
+			bvh.Refit(spheres);
+		}));
+
+		std::vector<uint8_t> hits(kRayCount);
+		results.push_back(Run("BVH::Raycast(50000)" , kRayCount , [&]() {
+			for (size_t i = 0; i < kRayCount; ++i) {
+				RaycastHit hit;
+				hits[i] = bvh.Raycast(rays[i] , 1000.0f , hit);
+			}
+		}));
+		Consume(hits[kRayCount / 2] != 0);
+
+		results.push_back(Run("BVH::IsOccluded(50000)" , kRayCount , [&]() {
+			for (size_t i = 0; i < kRayCount; ++i) {
+				hits[i] = bvh.IsOccluded(rays[i] , 1.0f);
+			}
+		}));
+		Consume(hits[kRayCount / 2] != 0);
+	}
+
+	{
+		//100万個の球のシーンファイル。書くのは1回だけで、開くのを測る
+		const uint32_t kObjectCount = 1000000;
+		const char *kScenePath = "benchmark_scene.bin";
+		std::mt19937 random(2468);
+		std::uniform_real_distribution<float> position(-100.0f , 100.0f);
+		SceneFileWriter writer;
+		writer.Open(kScenePath , kObjectCount , 0);
+		for (uint32_t i = 0; i < kObjectCount; ++i) {
+			writer.AddSphere({{position(random), position(random), position(random)}, 1.0f} , 0xFFFFFFFF);
+		}
+		if (writer.Close()) {
+			SceneFile sceneFile;
+			results.push_back(Run("SceneFile::Open(1000000)" , 1 , [&]() {
+				sceneFile.Open(kScenePath);
+				Consume(float(sceneFile.GetSphereCount()));
+				sceneFile.Close();
+			}));
+		}
+		std::remove(kScenePath);
+	}
+
+	{
+		//カメラの前に並べた1万個の球を線にする(batch_sizeは球の数)
+		const size_t kSphereCount = 10000;
+		std::vector<SphereInstance> instances;
+		for (size_t i = 0; i < kSphereCount; ++i) {
+			Vec3 center = {float(i % 100) * 0.3f - 15.0f, -1.0f, float(i / 100) * 0.3f};
+			instances.push_back({{center, 0.1f}, kColorWhite});
+		}
+		LineBatch lineBatch;
+		Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f , 1280.0f / 720.0f , 0.1f , 100.0f);
+		Matrix4x4 viewportMatrix = MakeViewportMatrix(0 , 0 , 1280.0f , 720.0f , 0.0f , 1.0f);
+		RenderContext context = MakeRenderContext(projectionMatrix , viewportMatrix , &lineBatch);
+		UpdateRenderContext(context , {0.0f, 1.9f, -6.49f} , {0.26f, 0.0f, 0.0f});
+		results.push_back(Run("DrawSphereInstances(10000)" , kSphereCount , [&]() {
+			lineBatch.Clear();
+			DrawSphereInstances(instances , context);
+		}));
+		Consume(float(lineBatch.GetCount()));
+	}
+
+	WriteJSON(stdout , results);
+	if (argc >= 2) {
+		FILE *file = fopen(argv[1] , "w");
+		if (!file) {
+			fprintf(stderr , "cannot open %s\n" , argv[1]);
+			return 1;
+		}
+		WriteJSON(file , results);
+		fclose(file);
+	}
+	return 0;
+}
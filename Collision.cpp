@@ -0,0 +1,409 @@
+#include "Collision.h"
+#include <assert.h>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+uint64_t MakeCellKey(int32_t x , int32_t y , int32_t z) {
+	//各軸21bitずつ詰める
+	const uint64_t kMask = (1ull << 21) - 1;
+	return (uint64_t(x) & kMask) | ((uint64_t(y) & kMask) << 21) | ((uint64_t(z) & kMask) << 42);
+}
+
+CellRange MakeCellRange(const CollisionWorld &world , const Sphere &sphere) {
+	float invCellSize = 1.0f / world.cellSize;
+	CellRange range;
+	range.minX = int32_t(std::floor((sphere.center.x - sphere.radius) * invCellSize));
+	range.minY = int32_t(std::floor((sphere.center.y - sphere.radius) * invCellSize));
+	range.minZ = int32_t(std::floor((sphere.center.z - sphere.radius) * invCellSize));
+	range.maxX = int32_t(std::floor((sphere.center.x + sphere.radius) * invCellSize));
+	range.maxY = int32_t(std::floor((sphere.center.y + sphere.radius) * invCellSize));
+	range.maxZ = int32_t(std::floor((sphere.center.z + sphere.radius) * invCellSize));
+	return range;
+}
+
+bool IsSameCellRange(const CellRange &r1 , const CellRange &r2) {
+	return r1.minX == r2.minX && r1.minY == r2.minY && r1.minZ == r2.minZ &&
+		r1.maxX == r2.maxX && r1.maxY == r2.maxY && r1.maxZ == r2.maxZ;
+}
+
+void InsertToCells(CollisionWorld &world , uint32_t id , const CellRange &range) {
+	for (int32_t z = range.minZ; z <= range.maxZ; ++z) {
+		for (int32_t y = range.minY; y <= range.maxY; ++y) {
+			for (int32_t x = range.minX; x <= range.maxX; ++x) {
+				world.cells[MakeCellKey(x , y , z)].push_back(id);
+			}
+		}
+	}
+}
+
+void RemoveFromCells(CollisionWorld &world , uint32_t id , const CellRange &range) {
+	for (int32_t z = range.minZ; z <= range.maxZ; ++z) {
+		for (int32_t y = range.minY; y <= range.maxY; ++y) {
+			for (int32_t x = range.minX; x <= range.maxX; ++x) {
+				auto it = world.cells.find(MakeCellKey(x , y , z));
+				if (it == world.cells.end()) {
+					continue;
+				}
+				std::vector<uint32_t> &cell = it->second;
+				for (size_t i = 0; i < cell.size(); ++i) {
+					if (cell[i] == id) {
+						cell[i] = cell.back();
+						cell.pop_back();
+						break;
+					}
+				}
+				if (cell.empty()) {
+					world.cells.erase(it);
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+float SignedDistance(const Vec3 &point , const Plane &plane) {
+	return point.x * plane.normal.x + point.y * plane.normal.y + point.z * plane.normal.z - plane.distance;
+}
+
+Plane MakeFrustumPlane(float a , float b , float c , float d) {
+	float length = std::sqrt(a * a + b * b + c * c);
+	return {{a / length, b / length, c / length}, -d / length};
+}
+
+Frustum MakeFrustum(const Matrix4x4 &viewProjectionMatrix) {
+	const Matrix4x4 &m = viewProjectionMatrix;
+	Frustum frustum;
+	frustum.planes[kFrustumLeft] = MakeFrustumPlane(m.m[0][3] + m.m[0][0] , m.m[1][3] + m.m[1][0] , m.m[2][3] + m.m[2][0] , m.m[3][3] + m.m[3][0]);
+	frustum.planes[kFrustumRight] = MakeFrustumPlane(m.m[0][3] - m.m[0][0] , m.m[1][3] - m.m[1][0] , m.m[2][3] - m.m[2][0] , m.m[3][3] - m.m[3][0]);
+	frustum.planes[kFrustumBottom] = MakeFrustumPlane(m.m[0][3] + m.m[0][1] , m.m[1][3] + m.m[1][1] , m.m[2][3] + m.m[2][1] , m.m[3][3] + m.m[3][1]);
+	frustum.planes[kFrustumTop] = MakeFrustumPlane(m.m[0][3] - m.m[0][1] , m.m[1][3] - m.m[1][1] , m.m[2][3] - m.m[2][1] , m.m[3][3] - m.m[3][1]);
+	frustum.planes[kFrustumNear] = MakeFrustumPlane(m.m[0][2] , m.m[1][2] , m.m[2][2] , m.m[3][2]);
+	frustum.planes[kFrustumFar] = MakeFrustumPlane(m.m[0][3] - m.m[0][2] , m.m[1][3] - m.m[1][2] , m.m[2][3] - m.m[2][2] , m.m[3][3] - m.m[3][2]);
+	return frustum;
+}
+
+bool IsSphereInFrustum(const Sphere &sphere , const Frustum &frustum) {
+	for (int i = 0; i < kFrustumPlaneCount; ++i) {
+		if (SignedDistance(sphere.center , frustum.planes[i]) < -sphere.radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsCollision(const Sphere &s1 , const Sphere &s2) {
+	float x = s1.center.x - s2.center.x;
+	float y = s1.center.y - s2.center.y;
+	float z = s1.center.z - s2.center.z;
+	//2乗のまま比べればsqrtはいらない
+	float lengthSq = x * x + y * y + z * z;
+	float radiusSum = s1.radius + s2.radius;
+	if (radiusSum * radiusSum >= lengthSq) {
+		return true;
+	}
+	return false;
+}
+
+CollisionWorld MakeCollisionWorld(float cellSize) {
+	assert(cellSize > 0.0f);
+	CollisionWorld world;
+	world.cellSize = cellSize;
+	return world;
+}
+
+uint32_t AddSphere(CollisionWorld &world , const Sphere &sphere) {
+	uint32_t id = uint32_t(world.spheres.size());
+	CellRange range = MakeCellRange(world , sphere);
+	world.spheres.push_back(sphere);
+	world.ranges.push_back(range);
+	InsertToCells(world , id , range);
+	return id;
+}
+
+void MoveSphere(CollisionWorld &world , uint32_t id , const Vec3 &center) {
+	assert(id < world.spheres.size());
+	world.spheres[id].center = center;
+
+	CellRange range = MakeCellRange(world , world.spheres[id]);
+	if (IsSameCellRange(range , world.ranges[id])) {
+		return;
+	}
+	RemoveFromCells(world , id , world.ranges[id]);
+	InsertToCells(world , id , range);
+	world.ranges[id] = range;
+}
+
+void FindCollisionPairs(const CollisionWorld &world , std::vector<CollisionPair> &pairs) {
+	pairs.clear();
+
+	for (const auto &[key , cell] : world.cells) {
+		for (size_t i = 0; i < cell.size(); ++i) {
+			for (size_t j = i + 1; j < cell.size(); ++j) {
+				uint32_t a = cell[i];
+				uint32_t b = cell[j];
+				const CellRange &ra = world.ranges[a];
+				const CellRange &rb = world.ranges[b];
+
+				//2つが同時に入っているマスのうち最小のマスでだけ判定する(重複防止)
+				int32_t x = ra.minX > rb.minX ? ra.minX : rb.minX;
+				int32_t y = ra.minY > rb.minY ? ra.minY : rb.minY;
+				int32_t z = ra.minZ > rb.minZ ? ra.minZ : rb.minZ;
+				if (MakeCellKey(x , y , z) != key) {
+					continue;
+				}
+
+				if (IsCollision(world.spheres[a] , world.spheres[b])) {
+					pairs.push_back({a < b ? a : b, a < b ? b : a});
+				}
+			}
+		}
+	}
+}
+
+bool IsSphereToPlaneCollision(const Sphere &sphere , const Plane &plane) {
+	//平面までの距離が半径以下なら当たり
+	float distance = SignedDistance(sphere.center , plane);
+	if (std::fabs(distance) <= sphere.radius) {
+		return true;
+	}
+	return false;
+}
+
+size_t GetHitMaskWordCount(size_t count) {
+	return (count + 63) / 64;
+}
+
+void TestSpheresToPlane(const float *x , const float *y , const float *z , const float *radius , size_t count , const Plane &plane , float *signedDistances , uint64_t *hitMask) {
+	for (size_t i = 0; i < GetHitMaskWordCount(count); ++i) {
+		hitMask[i] = 0;
+	}
+
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	{
+		const __m256 nx = _mm256_set1_ps(plane.normal.x);
+		const __m256 ny = _mm256_set1_ps(plane.normal.y);
+		const __m256 nz = _mm256_set1_ps(plane.normal.z);
+		const __m256 distance = _mm256_set1_ps(plane.distance);
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 d = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i) , nx) , _mm256_mul_ps(_mm256_loadu_ps(y + i) , ny)) , _mm256_mul_ps(_mm256_loadu_ps(z + i) , nz)) , distance);
+			_mm256_storeu_ps(signedDistances + i , d);
+
+			__m256 hit = _mm256_cmp_ps(_mm256_andnot_ps(signMask , d) , _mm256_loadu_ps(radius + i) , _CMP_LE_OQ);
+			hitMask[i / 64] |= uint64_t(_mm256_movemask_ps(hit)) << (i % 64);
+		}
+	}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	{
+		const __m128 nx = _mm_set1_ps(plane.normal.x);
+		const __m128 ny = _mm_set1_ps(plane.normal.y);
+		const __m128 nz = _mm_set1_ps(plane.normal.z);
+		const __m128 distance = _mm_set1_ps(plane.distance);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 d = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i) , nx) , _mm_mul_ps(_mm_loadu_ps(y + i) , ny)) , _mm_mul_ps(_mm_loadu_ps(z + i) , nz)) , distance);
+			_mm_storeu_ps(signedDistances + i , d);
+
+			__m128 hit = _mm_cmple_ps(_mm_andnot_ps(signMask , d) , _mm_loadu_ps(radius + i));
+			hitMask[i / 64] |= uint64_t(_mm_movemask_ps(hit)) << (i % 64);
+		}
+	}
+#endif
+
+	//残りはスカラーで
+	for (; i < count; ++i) {
+		float d = SignedDistance({x[i], y[i], z[i]} , plane);
+		signedDistances[i] = d;
+		if (std::fabs(d) <= radius[i]) {
+			hitMask[i / 64] |= 1ull << (i % 64);
+		}
+	}
+}
+
+void TestSpheresToPlanes(const SphereArray &spheres , const Plane *planes , size_t planeCount , std::vector<float> &signedDistances , std::vector<uint64_t> &hitMask) {
+	size_t count = spheres.size();
+	size_t wordCount = GetHitMaskWordCount(count);
+	signedDistances.resize(count * planeCount);
+	hitMask.resize(wordCount * planeCount);
+
+	for (size_t planeIndex = 0; planeIndex < planeCount; ++planeIndex) {
+		TestSpheresToPlane(
+			spheres.x.data() , spheres.y.data() , spheres.z.data() , spheres.radius.data() , count ,
+			planes[planeIndex] ,
+			signedDistances.data() + planeIndex * count , hitMask.data() + planeIndex * wordCount
+		);
+	}
+}
+
+bool SweepSphereToPlane(const Sphere &start , const Vec3 &end , const Plane &plane , SweepHit &hit) {
+	float startDistance = SignedDistance(start.center , plane);
+	float endDistance = SignedDistance(end , plane);
+
+	//始点のある側から見た距離にそろえる(バッチ版と同じ式)
+	float side = startDistance >= 0.0f ? 1.0f : -1.0f;
+	float nearDistance = std::fabs(startDistance);
+	float farDistance = endDistance * side;
+
+	if (nearDistance <= start.radius) {
+		hit.time = 0.0f;
+	} else if (farDistance <= start.radius) {
+		hit.time = (nearDistance - start.radius) / (nearDistance - farDistance);
+	} else {
+		return false;
+	}
+
+	hit.normal = MultiplyVec3(side , plane.normal);
+	Vec3 center = Add(start.center , MultiplyVec3(hit.time , Subtract(end , start.center)));
+	//重なっていた場合も平面上の点になるよう、中心を平面に落とす
+	hit.point = Subtract(center , MultiplyVec3(SignedDistance(center , plane) , plane.normal));
+	return true;
+}
+
+bool SweepSphereToSphere(const Sphere &s1 , const Vec3 &end1 , const Sphere &s2 , const Vec3 &end2 , SweepHit &hit) {
+	//s2から見たs1の相対運動にして、|p + v * t| = r1 + r2 を解く
+	Vec3 p = Subtract(s1.center , s2.center);
+	Vec3 v = Subtract(Subtract(end1 , s1.center) , Subtract(end2 , s2.center));
+	float radiusSum = s1.radius + s2.radius;
+
+	float a = Dot(v , v);
+	float b = Dot(p , v);
+	float c = Dot(p , p) - radiusSum * radiusSum;
+
+	if (c <= 0.0f) {
+		//始点で重なっている
+		hit.time = 0.0f;
+	} else {
+		//離れていく or 止まっている
+		if (b >= 0.0f || a == 0.0f) {
+			return false;
+		}
+		float discriminant = b * b - a * c;
+		if (discriminant < 0.0f) {
+			return false;
+		}
+		float time = (-b - std::sqrt(discriminant)) / a;
+		if (time > 1.0f) {
+			return false;
+		}
+		hit.time = time;
+	}
+
+	Vec3 offset = Add(p , MultiplyVec3(hit.time , v));
+	float length = std::sqrt(Dot(offset , offset));
+	hit.normal = length > 0.0f ? MultiplyVec3(1.0f / length , offset) : Vec3{0.0f, 1.0f, 0.0f};
+	Vec3 center2 = Add(s2.center , MultiplyVec3(hit.time , Subtract(end2 , s2.center)));
+	hit.point = Add(center2 , MultiplyVec3(s2.radius , hit.normal));
+	return true;
+}
+
+void SweepSpheresToPlane(const float *x , const float *y , const float *z , const float *radius , const float *endX , const float *endY , const float *endZ , size_t count , const Plane &plane , float *times , uint64_t *hitMask) {
+	for (size_t i = 0; i < GetHitMaskWordCount(count); ++i) {
+		hitMask[i] = 0;
+	}
+
+	size_t i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+	{
+		const __m128 nx = _mm_set1_ps(plane.normal.x);
+		const __m128 ny = _mm_set1_ps(plane.normal.y);
+		const __m128 nz = _mm_set1_ps(plane.normal.z);
+		const __m128 distance = _mm_set1_ps(plane.distance);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 startDistance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i) , nx) , _mm_mul_ps(_mm_loadu_ps(y + i) , ny)) , _mm_mul_ps(_mm_loadu_ps(z + i) , nz)) , distance);
+			__m128 endDistance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(endX + i) , nx) , _mm_mul_ps(_mm_loadu_ps(endY + i) , ny)) , _mm_mul_ps(_mm_loadu_ps(endZ + i) , nz)) , distance);
+			__m128 r = _mm_loadu_ps(radius + i);
+
+			//始点の符号をかけて、始点のある側から見た距離にする
+			__m128 side = _mm_and_ps(startDistance , signMask);
+			__m128 nearDistance = _mm_andnot_ps(signMask , startDistance);
+			__m128 farDistance = _mm_xor_ps(endDistance , side);
+
+			__m128 isOverlap = _mm_cmple_ps(nearDistance , r);
+			__m128 isReach = _mm_cmple_ps(farDistance , r);
+			__m128 time = _mm_div_ps(_mm_sub_ps(nearDistance , r) , _mm_sub_ps(nearDistance , farDistance));
+			time = _mm_andnot_ps(isOverlap , time);
+			__m128 isHit = _mm_or_ps(isOverlap , isReach);
+			_mm_storeu_ps(times + i , _mm_or_ps(_mm_and_ps(isHit , time) , _mm_andnot_ps(isHit , one)));
+
+			hitMask[i / 64] |= uint64_t(_mm_movemask_ps(isHit)) << (i % 64);
+		}
+	}
+#endif
+
+	//残りはスカラーで
+	for (; i < count; ++i) {
+		SweepHit hit;
+		if (SweepSphereToPlane({{x[i], y[i], z[i]}, radius[i]} , {endX[i], endY[i], endZ[i]} , plane , hit)) {
+			times[i] = hit.time;
+			hitMask[i / 64] |= 1ull << (i % 64);
+		} else {
+			times[i] = 1.0f;
+		}
+	}
+}
+
+void SweepSpheresToPlane(const SphereArray &starts , const Vec3Array &ends , const Plane &plane , std::vector<float> &times , std::vector<uint64_t> &hitMask) {
+	assert(starts.size() == ends.size());
+	size_t count = starts.size();
+	times.resize(count);
+	hitMask.resize(GetHitMaskWordCount(count));
+
+	SweepSpheresToPlane(
+		starts.x.data() , starts.y.data() , starts.z.data() , starts.radius.data() ,
+		ends.x.data() , ends.y.data() , ends.z.data() , count ,
+		plane , times.data() , hitMask.data()
+	);
+}
+
+bool RaycastSphere(const Ray &ray , const Sphere &sphere , float maxT , float &t) {
+	Vec3 m = Subtract(ray.origin , sphere.center);
+	float b = Dot(m , ray.direction);
+	float c = Dot(m , m) - sphere.radius * sphere.radius;
+	//外側にいて離れていく
+	if (c > 0.0f && b > 0.0f) {
+		return false;
+	}
+	if (c <= 0.0f) {
+		t = 0.0f;
+		return true;
+	}
+	float a = Dot(ray.direction , ray.direction);
+	float discriminant = b * b - a * c;
+	if (discriminant < 0.0f) {
+		return false;
+	}
+	float hitT = (-b - std::sqrt(discriminant)) / a;
+	if (hitT > maxT) {
+		return false;
+	}
+	t = hitT;
+	return true;
+}
+
+bool RaycastPlane(const Ray &ray , const Plane &plane , float maxT , float &t) {
+	float denominator = Dot(plane.normal , ray.direction);
+	if (denominator == 0.0f) {
+		return false;
+	}
+	float hitT = (plane.distance - Dot(plane.normal , ray.origin)) / denominator;
+	if (hitT < 0.0f || hitT > maxT) {
+		return false;
+	}
+	t = hitT;
+	return true;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "MyMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//当たり判定と視錐台(Noviceに依存しない)
+
+//法線は正規化済みであること
+float SignedDistance(const Vec3 &point , const Plane &plane);
+
+//視錐台(法線は内側向き)
+enum FrustumPlane {
+	kFrustumLeft ,
+	kFrustumRight ,
+	kFrustumBottom ,
+	kFrustumTop ,
+	kFrustumNear ,
+	kFrustumFar ,
+	kFrustumPlaneCount
+};
+
+struct Frustum {
+	Plane planes[kFrustumPlaneCount];
+};
+
+//a*x + b*y + c*z + d >= 0 が内側になる平面を Plane にする
+Plane MakeFrustumPlane(float a , float b , float c , float d);
+
+//ビュープロジェクション行列から視錐台を取り出す
+//行ベクトルなので clip = v * M の各成分は行列の列になる(zは0～wの範囲)
+Frustum MakeFrustum(const Matrix4x4 &viewProjectionMatrix);
+
+//完全に外側ならfalse
+bool IsSphereInFrustum(const Sphere &sphere , const Frustum &frustum);
+
+//球同士(接していても当たり)
+bool IsCollision(const Sphere &s1 , const Sphere &s2);
+
+//一様グリッドの1マスの範囲
+struct CellRange {
+	int32_t minX;
+	int32_t minY;
+	int32_t minZ;
+	int32_t maxX;
+	int32_t maxY;
+	int32_t maxZ;
+};
+
+struct CollisionPair {
+	uint32_t a;
+	uint32_t b;
+};
+
+//たくさんの球の当たり判定(一様グリッドで候補を絞ってから球同士を判定)
+struct CollisionWorld {
+	float cellSize;
+	std::vector<Sphere> spheres;
+	std::vector<CellRange> ranges; //球ごとに今入っているマス
+	std::unordered_map<uint64_t , std::vector<uint32_t>> cells;
+};
+
+//cellSizeは球の直径くらいがちょうどいい
+CollisionWorld MakeCollisionWorld(float cellSize);
+
+//追加した球の番号を返す
+uint32_t AddSphere(CollisionWorld &world , const Sphere &sphere);
+
+//動いた球だけ更新する。マスが変わらなければグリッドは触らない
+void MoveSphere(CollisionWorld &world , uint32_t id , const Vec3 &center);
+
+//重なっている球のペアを全部集める
+void FindCollisionPairs(const CollisionWorld &world , std::vector<CollisionPair> &pairs);
+
+//球と平面(接していても当たり)
+bool IsSphereToPlaneCollision(const Sphere &sphere , const Plane &plane);
+
+//SoAの球の配列
+struct SphereArray {
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+
+	size_t size() const { return x.size(); }
+
+	void push_back(const Sphere &sphere) {
+		x.push_back(sphere.center.x);
+		y.push_back(sphere.center.y);
+		z.push_back(sphere.center.z);
+		radius.push_back(sphere.radius);
+	}
+};
+
+//ビットマスクに必要なuint64_tの数
+size_t GetHitMaskWordCount(size_t count);
+
+//まとめて球と平面の判定
+//signedDistances[i]に符号付き距離、hitMaskのi番目のbitに当たったかを書く
+void TestSpheresToPlane(const float *x , const float *y , const float *z , const float *radius , size_t count , const Plane &plane , float *signedDistances , uint64_t *hitMask);
+
+//複数の平面とまとめて判定
+//結果は平面ごとに signedDistances[planeIndex * count + i] , hitMask[planeIndex * GetHitMaskWordCount(count) + i / 64]
+void TestSpheresToPlanes(const SphereArray &spheres , const Plane *planes , size_t planeCount , std::vector<float> &signedDistances , std::vector<uint64_t> &hitMask);
+
+//連続判定(スイープ)の結果
+struct SweepHit {
+	float time; //始点0～終点1のどこで最初に触れたか(始点で重なっていれば0)
+	Vec3 normal; //動いている球を押し返す向き
+	Vec3 point; //接触点
+};
+
+//球が start から end まで動く間に平面に触れるか(平面の裏からでも当たる)
+//当たったら最初に触れた時刻をhitに入れる。1フレームで平面をすり抜けても取りこぼさない
+bool SweepSphereToPlane(const Sphere &start , const Vec3 &end , const Plane &plane , SweepHit &hit);
+
+//2つの球がそれぞれ end1 , end2 まで動く間に触れるか(止まっている球なら end2 = s2.center)
+//normalはs2からs1へ向かう向き
+bool SweepSphereToSphere(const Sphere &s1 , const Vec3 &end1 , const Sphere &s2 , const Vec3 &end2 , SweepHit &hit);
+
+//たくさんの球をまとめてスイープ判定
+//times[i]に触れた時刻(当たらなければ1)、hitMaskのi番目のbitに当たったかを書く
+//押し返す向きは始点が平面の表なら plane.normal 、裏なら逆向き
+void SweepSpheresToPlane(const float *x , const float *y , const float *z , const float *radius , const float *endX , const float *endY , const float *endZ , size_t count , const Plane &plane , float *times , uint64_t *hitMask);
+
+void SweepSpheresToPlane(const SphereArray &starts , const Vec3Array &ends , const Plane &plane , std::vector<float> &times , std::vector<uint64_t> &hitMask);
+
+//半直線(origin + direction * t , t >= 0)
+struct Ray {
+	Vec3 origin;
+	Vec3 direction;
+};
+
+//球に当たるか。tは direction の長さを1とした距離で、maxT より先は見ない
+//始点が球の中ならt = 0
+bool RaycastSphere(const Ray &ray , const Sphere &sphere , float maxT , float &t);
+
+//平面に当たるか(裏からでも当たる)
+bool RaycastPlane(const Ray &ray , const Plane &plane , float maxT , float &t);
@@ -0,0 +1,21 @@
+//ウィンドウ無しで -headless と -replay を回す(Linuxのビルド用。Windowsでは同じ物をWinMainから呼ぶ)
+//  ./headless [-scene ファイル] [-latency 0|1] [-dedup] -headless フレーム数 [出力.ppm] [計測.csv]
+//  ./headless [-scene ファイル] [-latency 0|1] [-dedup] -replay 記録 [計測.csv] [出力.ppm]
+#include "App.h"
+#include <cstdio>
+#include <sstream>
+
+int main(int argc , char **argv) {
+	//WinMainと同じく空白区切りの1行にして読む
+	std::stringstream commandLine;
+	for (int i = 1; i < argc; ++i) {
+		commandLine << argv[i] << ' ';
+	}
+
+	CommandLineOptions options = ParseCommandLine(commandLine);
+	if (options.mode == kRunWindow) {
+		std::fprintf(stderr , "usage: %s [-scene file] [-latency 0|1] [-dedup] (-headless frames [out.ppm] [profile.csv] | -replay input [profile.csv] [out.ppm])\n" , argv[0]);
+		return 1;
+	}
+	return RunWithoutWindow(options);
+}
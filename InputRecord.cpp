@@ -0,0 +1,215 @@
+#include "InputRecord.h"
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+//値をそのまま書くので
+static_assert(std::endian::native == std::endian::little , "InputRecord requires a little-endian host");
+
+namespace {
+
+const char kInputRecordMagic[8] = {'M', 'T', '3', 'I', 'N', 'P', 'U', 'T'};
+const size_t kInputRecordHeaderSize = 16;
+
+//キー以外の物。bitの番号はこの並び順
+struct InputField {
+	size_t offset;
+	size_t size;
+};
+
+const InputField kInputFields[] = {
+	{offsetof(FrameInput , camaraTranslate) , sizeof(Vec3)},
+	{offsetof(FrameInput , camaraRotate) , sizeof(Vec3)},
+	{offsetof(FrameInput , point1) , sizeof(Sphere)},
+	{offsetof(FrameInput , point2) , sizeof(Plane)},
+	{offsetof(FrameInput , debugSphereCount) , sizeof(int32_t)},
+	//マウスはxとyを一緒に
+	{offsetof(FrameInput , mouseX) , sizeof(int32_t) * 2},
+	{offsetof(FrameInput , isSphereHiddenLine) , sizeof(bool)},
+};
+const size_t kInputFieldCount = sizeof(kInputFields) / sizeof(kInputFields[0]);
+const uint8_t kInputKeysBit = uint8_t(1 << kInputFieldCount);
+static_assert(offsetof(FrameInput , mouseY) == offsetof(FrameInput , mouseX) + sizeof(int32_t) , "mouseX and mouseY must be adjacent");
+
+} // namespace
+
+InputRecorder::~InputRecorder() {
+	if (file_) {
+		Close();
+	}
+}
+
+bool InputRecorder::Open(const char *filePath) {
+	if (file_) {
+		return false;
+	}
+#if defined(_MSC_VER)
+	if (fopen_s(&file_ , filePath , "wb") != 0) {
+		file_ = nullptr;
+		return false;
+	}
+#else
+	file_ = std::fopen(filePath , "wb");
+#endif
+	if (file_ == nullptr) {
+		return false;
+	}
+
+	//ヘッダは閉じる時に書き直す
+	uint8_t header[kInputRecordHeaderSize] = {};
+	isFailed_ = std::fwrite(header , sizeof(header) , 1 , file_) != 1;
+	frameCount_ = 0;
+	//最初のフレームは全部0と比べる
+	previous_ = {};
+	return !isFailed_;
+}
+
+bool InputRecorder::Record(const FrameInput &input) {
+	if (!file_ || isFailed_) {
+		return false;
+	}
+
+	const uint8_t *current = reinterpret_cast<const uint8_t *>(&input);
+	const uint8_t *previous = reinterpret_cast<const uint8_t *>(&previous_);
+	buffer_.clear();
+	buffer_.push_back(0);
+
+	//floatもbitで比べるので、戻した時に同じ値になる
+	uint8_t changedBits = 0;
+	for (size_t i = 0; i < kInputFieldCount; ++i) {
+		const InputField &field = kInputFields[i];
+		if (std::memcmp(current + field.offset , previous + field.offset , field.size) != 0) {
+			changedBits |= uint8_t(1 << i);
+			buffer_.insert(buffer_.end() , current + field.offset , current + field.offset + field.size);
+		}
+	}
+
+	uint16_t changedKeyCount = 0;
+	for (size_t key = 0; key < 256; ++key) {
+		if (input.keys[key] != previous_.keys[key]) {
+			++changedKeyCount;
+		}
+	}
+	if (changedKeyCount > 0) {
+		changedBits |= kInputKeysBit;
+		buffer_.push_back(uint8_t(changedKeyCount));
+		buffer_.push_back(uint8_t(changedKeyCount >> 8));
+		for (size_t key = 0; key < 256; ++key) {
+			if (input.keys[key] != previous_.keys[key]) {
+				buffer_.push_back(uint8_t(key));
+				buffer_.push_back(input.keys[key]);
+			}
+		}
+	}
+	buffer_[0] = changedBits;
+
+	if (std::fwrite(buffer_.data() , 1 , buffer_.size() , file_) != buffer_.size()) {
+		isFailed_ = true;
+		return false;
+	}
+	previous_ = input;
+	++frameCount_;
+	return true;
+}
+
+bool InputRecorder::Close() {
+	if (!file_) {
+		return false;
+	}
+
+	uint8_t header[kInputRecordHeaderSize];
+	std::memcpy(header , kInputRecordMagic , sizeof(kInputRecordMagic));
+	std::memcpy(header + 8 , &kInputRecordVersion , sizeof(uint32_t));
+	std::memcpy(header + 12 , &frameCount_ , sizeof(uint32_t));
+	bool isSucceeded = !isFailed_ && std::fseek(file_ , 0 , SEEK_SET) == 0 && std::fwrite(header , sizeof(header) , 1 , file_) == 1;
+
+	if (std::fclose(file_) != 0) {
+		isSucceeded = false;
+	}
+	file_ = nullptr;
+	return isSucceeded;
+}
+
+bool InputPlayer::Open(const char *filePath) {
+	FILE *file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file , filePath , "rb") != 0) {
+		return false;
+	}
+#else
+	file = std::fopen(filePath , "rb");
+#endif
+	if (file == nullptr) {
+		return false;
+	}
+
+	data_.clear();
+	uint8_t chunk[65536];
+	size_t readSize = 0;
+	while ((readSize = std::fread(chunk , 1 , sizeof(chunk) , file)) > 0) {
+		data_.insert(data_.end() , chunk , chunk + readSize);
+	}
+	std::fclose(file);
+
+	uint32_t version = 0;
+	if (data_.size() < kInputRecordHeaderSize || std::memcmp(data_.data() , kInputRecordMagic , sizeof(kInputRecordMagic)) != 0) {
+		return false;
+	}
+	std::memcpy(&version , data_.data() + 8 , sizeof(uint32_t));
+	std::memcpy(&frameCount_ , data_.data() + 12 , sizeof(uint32_t));
+	if (version != kInputRecordVersion) {
+		return false;
+	}
+
+	position_ = kInputRecordHeaderSize;
+	frameIndex_ = 0;
+	current_ = {};
+	return true;
+}
+
+bool InputPlayer::Read(void *output , size_t size) {
+	if (position_ + size > data_.size()) {
+		return false;
+	}
+	std::memcpy(output , data_.data() + position_ , size);
+	position_ += size;
+	return true;
+}
+
+bool InputPlayer::Next(FrameInput &input) {
+	if (frameIndex_ >= frameCount_) {
+		return false;
+	}
+
+	uint8_t changedBits = 0;
+	if (!Read(&changedBits , 1)) {
+		return false;
+	}
+
+	uint8_t *current = reinterpret_cast<uint8_t *>(&current_);
+	for (size_t i = 0; i < kInputFieldCount; ++i) {
+		const InputField &field = kInputFields[i];
+		if ((changedBits & (1 << i)) && !Read(current + field.offset , field.size)) {
+			return false;
+		}
+	}
+
+	if (changedBits & kInputKeysBit) {
+		uint8_t count[2];
+		if (!Read(count , 2)) {
+			return false;
+		}
+		uint16_t changedKeyCount = uint16_t(count[0] | (count[1] << 8));
+		for (uint16_t i = 0; i < changedKeyCount; ++i) {
+			uint8_t keyAndValue[2];
+			if (!Read(keyAndValue , 2)) {
+				return false;
+			}
+			current_.keys[keyAndValue[0]] = keyAndValue[1];
+		}
+	}
+
+	++frameIndex_;
+	input = current_;
+	return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Collision.h"
+#include "MyMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+//ウィンドウのループが1フレームで受け取る入力(ImGuiで触る値とキーとマウス)
+struct FrameInput {
+	Vec3 camaraTranslate;
+	Vec3 camaraRotate;
+	Sphere point1;
+	Plane point2;
+	int32_t debugSphereCount;
+	int32_t mouseX;
+	int32_t mouseY;
+	bool isSphereHiddenLine;
+	uint8_t keys[256];
+};
+
+//入力の記録ファイル(リトルエンディアン)
+//  [ヘッダ 16byte: "MT3INPUT" , version , frameCount]
+//  フレームごとに [変わった物のbit 1byte][変わった物の値...]
+//前のフレームと同じ物は書かないので、触っていないフレームは1byteになる
+//キーは [変わった数 2byte][番号 1byte , 値 1byte]... で書く
+const uint32_t kInputRecordVersion = 2;
+
+//入力をフレームごとに前のフレームとの差分で書く
+class InputRecorder {
+public:
+	InputRecorder() = default;
+	~InputRecorder();
+
+	InputRecorder(const InputRecorder &) = delete;
+	InputRecorder &operator=(const InputRecorder &) = delete;
+
+	bool Open(const char *filePath);
+
+	//1フレーム分を足す
+	bool Record(const FrameInput &input);
+
+	//フレーム数をヘッダに書いて閉じる
+	bool Close();
+
+	bool IsOpen() const { return file_ != nullptr; }
+	uint32_t GetFrameCount() const { return frameCount_; }
+
+private:
+	FILE *file_ = nullptr;
+	bool isFailed_ = false;
+	uint32_t frameCount_ = 0;
+	FrameInput previous_ = {};
+	std::vector<uint8_t> buffer_; //1フレーム分を組み立てる
+};
+
+//記録した入力を最初のフレームから順に戻す
+class InputPlayer {
+public:
+	//ファイルを全部読む(小さいので一度に読む)
+	//戻り値は読めたか(形式が違えばfalse)
+	bool Open(const char *filePath);
+
+	//次のフレームの入力
+	//最後まで読んだか、壊れていたらfalse
+	bool Next(FrameInput &input);
+
+	uint32_t GetFrameCount() const { return frameCount_; }
+
+private:
+	bool Read(void *output , size_t size);
+
+	std::vector<uint8_t> data_;
+	size_t position_ = 0;
+	uint32_t frameCount_ = 0;
+	uint32_t frameIndex_ = 0;
+	FrameInput current_ = {};
+};
@@ -0,0 +1,183 @@
+//入力を記録して流し直し、同じFrameInputの並びが戻るかを確かめる(CMakeLists.txtのctest)
+//途中で切れた記録は最後まで読めずに止まることも確かめる
+#include "InputRecord.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//後ろの詰め物は比べない(floatはbitで比べる)
+bool IsSameInput(const FrameInput &a , const FrameInput &b) {
+	return std::memcmp(&a , &b , offsetof(FrameInput , keys) + sizeof(a.keys)) == 0;
+}
+
+//フレームごとに一部だけ変える(何も変えないフレームも、キーを全部変えるフレームも混ぜる)
+std::vector<FrameInput> MakeInputs(size_t frameCount , std::mt19937 &random) {
+	std::uniform_int_distribution<int> percent(0 , 99);
+	std::uniform_real_distribution<float> value(-10.0f , 10.0f);
+	std::vector<FrameInput> inputs;
+	FrameInput input = {};
+	for (size_t frame = 0; frame < frameCount; ++frame) {
+		if (percent(random) < 30) {
+			input.camaraTranslate = {value(random), value(random), value(random)};
+		}
+		if (percent(random) < 30) {
+			input.camaraRotate = {value(random), -0.0f, value(random)};
+		}
+		if (percent(random) < 20) {
+			input.point1 = {{value(random), value(random), value(random)}, value(random)};
+		}
+		if (percent(random) < 20) {
+			input.point2 = {{value(random), value(random), value(random)}, value(random)};
+		}
+		if (percent(random) < 10) {
+			input.debugSphereCount = int32_t(random() % 20001);
+		}
+		if (percent(random) < 50) {
+			input.mouseX = int32_t(random() % 1280);
+		}
+		if (percent(random) < 50) {
+			input.mouseY = int32_t(random() % 720);
+		}
+		if (percent(random) < 10) {
+			input.isSphereHiddenLine = !input.isSphereHiddenLine;
+		}
+		if (frame == frameCount / 2) {
+			//256個全部(変わった数が1byteに収まらない)
+			for (int key = 0; key < 256; ++key) {
+				input.keys[key] = uint8_t(input.keys[key] ^ 0x80);
+			}
+		} else if (percent(random) < 40) {
+			input.keys[random() % 256] = uint8_t(random());
+		}
+		inputs.push_back(input);
+	}
+	return inputs;
+}
+
+bool RecordInputs(const std::string &filePath , const std::vector<FrameInput> &inputs) {
+	InputRecorder recorder;
+	if (!recorder.Open(filePath.c_str())) {
+		return false;
+	}
+	for (const FrameInput &input : inputs) {
+		if (!recorder.Record(input)) {
+			return false;
+		}
+	}
+	return recorder.GetFrameCount() == inputs.size() && recorder.Close();
+}
+
+//記録を流し直す。戻り値は読めたフレーム数(最初から合わなくなったらそこまで)
+size_t ReplayInputs(const std::string &filePath , const std::vector<FrameInput> &inputs , bool &isOpened , uint32_t &frameCount) {
+	InputPlayer player;
+	isOpened = player.Open(filePath.c_str());
+	frameCount = player.GetFrameCount();
+	if (!isOpened) {
+		return 0;
+	}
+	size_t readCount = 0;
+	FrameInput input;
+	while (readCount < inputs.size() && player.Next(input)) {
+		if (!IsSameInput(input , inputs[readCount])) {
+			break;
+		}
+		++readCount;
+	}
+	return readCount;
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(20240619);
+	std::string filePath = (std::filesystem::temp_directory_path() / "MT3InputRecordTest.bin").string();
+
+	int failureCount = 0;
+
+	//そのまま戻る
+	const size_t kFrameCounts[] = {0 , 1 , 2 , 300};
+	for (size_t frameCount : kFrameCounts) {
+		std::vector<FrameInput> inputs = MakeInputs(frameCount , random);
+		bool isOpened = false;
+		uint32_t recordedFrameCount = 0;
+		size_t readCount = RecordInputs(filePath , inputs) ? ReplayInputs(filePath , inputs , isOpened , recordedFrameCount) : 0;
+		if (!isOpened || recordedFrameCount != frameCount || readCount != frameCount) {
+			std::fprintf(stderr , "frames %zu: opened %d , header %u , replayed %zu\n" , frameCount , int(isOpened) , recordedFrameCount , readCount);
+			++failureCount;
+		}
+	}
+
+	//どこで切れても、ヘッダのフレーム数まで読めてしまうことはない(読めた所までは同じ)
+	{
+		std::vector<FrameInput> inputs = MakeInputs(40 , random);
+		RecordInputs(filePath , inputs);
+		std::vector<char> data(std::filesystem::file_size(filePath));
+		FILE *file = std::fopen(filePath.c_str() , "rb");
+		size_t dataSize = std::fread(data.data() , 1 , data.size() , file);
+		std::fclose(file);
+
+		for (size_t size = 0; size < dataSize; ++size) {
+			file = std::fopen(filePath.c_str() , "wb");
+			std::fwrite(data.data() , 1 , size , file);
+			std::fclose(file);
+
+			bool isOpened = false;
+			uint32_t recordedFrameCount = 0;
+			size_t readCount = ReplayInputs(filePath , inputs , isOpened , recordedFrameCount);
+			//ヘッダ(16byte)より短ければ開けない。開けても最後のフレームまでは読めない
+			bool isRejected = size < 16 ? !isOpened : (isOpened && readCount < recordedFrameCount);
+			if (!isRejected) {
+				std::fprintf(stderr , "truncated at %zu: opened %d , replayed %zu of %u\n" , size , int(isOpened) , readCount , recordedFrameCount);
+				++failureCount;
+			}
+		}
+	}
+
+	//Closeを呼ばなくてもデストラクタがヘッダを書く
+	{
+		{
+			InputRecorder recorder;
+			recorder.Open(filePath.c_str());
+			recorder.Record(MakeInputs(1 , random)[0]);
+		}
+		InputPlayer player;
+		if (!player.Open(filePath.c_str()) || player.GetFrameCount() != 1) {
+			std::fprintf(stderr , "destructor: header not written\n");
+			++failureCount;
+		}
+	}
+
+	//途中で落ちた記録(ヘッダが0のまま)と、版が違う記録
+	{
+		RecordInputs(filePath , MakeInputs(3 , random));
+		FILE *file = std::fopen(filePath.c_str() , "r+b");
+		const uint8_t kZeroHeader[16] = {};
+		std::fwrite(kZeroHeader , sizeof(kZeroHeader) , 1 , file);
+		std::fclose(file);
+		InputPlayer player;
+		if (player.Open(filePath.c_str())) {
+			std::fprintf(stderr , "zero header: opened\n");
+			++failureCount;
+		}
+
+		RecordInputs(filePath , MakeInputs(3 , random));
+		file = std::fopen(filePath.c_str() , "r+b");
+		uint32_t version = kInputRecordVersion + 1;
+		std::fseek(file , 8 , SEEK_SET);
+		std::fwrite(&version , sizeof(version) , 1 , file);
+		std::fclose(file);
+		if (player.Open(filePath.c_str())) {
+			std::fprintf(stderr , "other version: opened\n");
+			++failureCount;
+		}
+	}
+
+	std::filesystem::remove(filePath);
+	std::printf("InputRecord: failures %d\n" , failureCount);
+	return failureCount == 0 ? 0 : 1;
+}
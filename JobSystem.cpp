@@ -0,0 +1,119 @@
+#include "JobSystem.h"
+#include <cassert>
+
+uint32_t JobSystem::GetDefaultWorkerCount() {
+	uint32_t coreCount = std::thread::hardware_concurrency();
+	return coreCount > 1 ? coreCount - 1 : 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount) {
+	for (uint32_t i = 0; i < workerCount + 1; ++i) {
+		queues_.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		workers_.emplace_back(&JobSystem::WorkerLoop , this , i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex_);
+		isRunning_ = false;
+	}
+	wakeCondition_.notify_all();
+	for (std::thread &worker : workers_) {
+		worker.join();
+	}
+}
+
+bool JobSystem::TryPopJob(uint32_t index , std::function<void()> &job) {
+	//自分のキュー
+	{
+		WorkerQueue &queue = *queues_[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			--queuedJobCount_;
+			return true;
+		}
+	}
+
+	//他のキューから盗む
+	for (size_t offset = 1; offset < queues_.size(); ++offset) {
+		WorkerQueue &queue = *queues_[(index + offset) % queues_.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			--queuedJobCount_;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::WorkerLoop(uint32_t index) {
+	std::function<void()> job;
+	while (true) {
+		if (TryPopJob(index , job)) {
+			job();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeMutex_);
+		wakeCondition_.wait(lock , [this] { return !isRunning_ || queuedJobCount_ > 0; });
+		if (!isRunning_) {
+			return;
+		}
+	}
+}
+
+void JobSystem::ParallelFor(size_t count , size_t chunkSize , const std::function<void(size_t , size_t , size_t)> &job) {
+	assert(chunkSize > 0);
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+	//1チャンクしかない、またはワーカーがいないならその場で実行
+	if (chunkCount <= 1 || workers_.empty()) {
+		for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+			size_t begin = chunkIndex * chunkSize;
+			job(begin , begin + chunkSize < count ? begin + chunkSize : count , chunkIndex);
+		}
+		return;
+	}
+
+	Latch latch;
+	latch.remainingCount = chunkCount;
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+		size_t begin = chunkIndex * chunkSize;
+		size_t end = begin + chunkSize < count ? begin + chunkSize : count;
+
+		//キューに順番に配る
+		WorkerQueue &queue = *queues_[chunkIndex % queues_.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back([&job , &latch , begin , end , chunkIndex] {
+			job(begin , end , chunkIndex);
+			std::lock_guard<std::mutex> latchLock(latch.mutex);
+			if (--latch.remainingCount == 0) {
+				latch.condition.notify_all();
+			}
+		});
+		++queuedJobCount_;
+	}
+	{
+		//待っているワーカーが起きそびれないようにロックを通してから起こす
+		std::lock_guard<std::mutex> lock(wakeMutex_);
+	}
+	wakeCondition_.notify_all();
+
+	//呼び出し元もキューが空になるまで手伝う(他の呼び出しの仕事でもよい。jobの中から呼んだ時も止まらない)
+	//空になったらこの呼び出しのチャンクは全部誰かが実行中なので、終わるのを寝て待つ
+	uint32_t callerIndex = uint32_t(queues_.size() - 1);
+	std::function<void()> task;
+	while (TryPopJob(callerIndex , task)) {
+		task();
+	}
+	std::unique_lock<std::mutex> lock(latch.mutex);
+	latch.condition.wait(lock , [&latch] { return latch.remainingCount == 0; });
+}
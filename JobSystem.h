@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//ワーカーごとのキューと盗み合い(work stealing)で仕事を分けるスレッドプール
+class JobSystem {
+public:
+	//workerCountはワーカースレッド数。0なら呼び出し元スレッドだけで実行する
+	explicit JobSystem(uint32_t workerCount = GetDefaultWorkerCount());
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	//[0, count) を chunkSize ごとに分けて並列に実行し、全部終わるまで待つ
+	//呼び出し元スレッドも仕事を手伝う。待つのはこの呼び出しのチャンクだけ
+	//別のスレッドから同時に呼んでも、jobの中から呼んでもよい
+	//jobは job(begin, end, chunkIndex) で呼ぶ
+	void ParallelFor(size_t count , size_t chunkSize , const std::function<void(size_t , size_t , size_t)> &job);
+
+	uint32_t GetWorkerCount() const { return uint32_t(workers_.size()); }
+
+	//コア数 - 1(メインスレッドの分)
+	static uint32_t GetDefaultWorkerCount();
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> jobs;
+	};
+
+	//ParallelFor 1回分の残りのチャンク数
+	//最後のチャンクが数を減らして起こし終わるまで呼び出し元が抜けないように、数はmutexの中で触る
+	struct Latch {
+		std::mutex mutex;
+		std::condition_variable condition;
+		size_t remainingCount;
+	};
+
+	void WorkerLoop(uint32_t index);
+
+	//自分のキューの後ろから取り、空なら他のキューの前から盗む
+	bool TryPopJob(uint32_t index , std::function<void()> &job);
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues_; //最後の1つは呼び出し元スレッド用
+	std::vector<std::thread> workers_;
+	std::mutex wakeMutex_;
+	std::condition_variable wakeCondition_;
+	std::atomic<size_t> queuedJobCount_ = 0;
+	bool isRunning_ = true;
+};
@@ -0,0 +1,57 @@
+#include "LineBatch.h"
+#include <algorithm>
+
+LineBatch::LineBatch(size_t capacity) {
+	lines_.reserve(capacity);
+}
+
+void LineBatch::DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) {
+	lines_.push_back({x1, y1, x2, y2, color});
+}
+
+void LineBatch::Append(const LineBatch &other) {
+	lines_.insert(lines_.end() , other.lines_.begin() , other.lines_.end());
+}
+
+std::vector<LineBatch> &LineBatch::GetChunkBatches(size_t count) {
+	if (chunkBatches_.size() < count) {
+		chunkBatches_.resize(count);
+	}
+	return chunkBatches_;
+}
+
+void LineBatch::Flush(LineSink &sink , bool isDeduplicate , bool isSortByColor) {
+	if (isDeduplicate) {
+		Deduplicate();
+	} else if (isSortByColor) {
+		//同じ色の中では追加した順のまま
+		std::stable_sort(lines_.begin() , lines_.end() , [](const Line &a , const Line &b) { return a.color < b.color; });
+	}
+
+	for (const Line &line : lines_) {
+		sink.DrawLine(line.x1 , line.y1 , line.x2 , line.y2 , line.color);
+	}
+	lines_.clear();
+}
+
+void LineBatch::Deduplicate() {
+	//端点の順番をそろえてから並べて、隣同士で同じものを消す
+	for (Line &line : lines_) {
+		if (line.x1 > line.x2 || (line.x1 == line.x2 && line.y1 > line.y2)) {
+			std::swap(line.x1 , line.x2);
+			std::swap(line.y1 , line.y2);
+		}
+	}
+	auto less = [](const Line &a , const Line &b) {
+		if (a.color != b.color) { return a.color < b.color; }
+		if (a.x1 != b.x1) { return a.x1 < b.x1; }
+		if (a.y1 != b.y1) { return a.y1 < b.y1; }
+		if (a.x2 != b.x2) { return a.x2 < b.x2; }
+		return a.y2 < b.y2;
+	};
+	auto equal = [](const Line &a , const Line &b) {
+		return a.color == b.color && a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+	};
+	std::sort(lines_.begin() , lines_.end() , less);
+	lines_.erase(std::unique(lines_.begin() , lines_.end() , equal) , lines_.end());
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "LineSink.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//1フレーム分の線をためておき、最後にまとめて出力する
+class LineBatch : public LineSink {
+public:
+	struct Line {
+		int x1;
+		int y1;
+		int x2;
+		int y2;
+		uint32_t color;
+	};
+
+	//capacityは最初に確保しておく本数
+	explicit LineBatch(size_t capacity = 4096);
+
+	//線を追加する(描画はFlushまで行わない)
+	void DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) override;
+
+	//ためた線を全部sinkに出して空にする(確保したメモリはそのまま使い回す)
+	//isDeduplicateなら同じ線(向きが逆も含む)を1本にする
+	//isSortByColorなら色ごとにまとめて出す
+	void Flush(LineSink &sink , bool isDeduplicate = false , bool isSortByColor = false);
+
+	//同じ線(向きが逆も含む)を1本にする。線は色ごとに並べ変わるので、重なる順番も変わる
+	void Deduplicate();
+
+	//出力せずに空にする
+	void Clear() { lines_.clear(); }
+
+	//別のバッチの線を後ろにつなげる
+	void Append(const LineBatch &other);
+
+	//並列に線を作る時のチャンクごとの置き場(DrawParallelChunks用。確保はこのバッチが持って使い回す)
+	//戻り値はcount個以上のバッチ
+	std::vector<LineBatch> &GetChunkBatches(size_t count);
+
+	const std::vector<Line> &GetLines() const { return lines_; }
+	size_t GetCount() const { return lines_.size(); }
+
+private:
+	std::vector<Line> lines_;
+	std::vector<LineBatch> chunkBatches_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+//線の出力先
+class LineSink {
+public:
+	virtual ~LineSink() = default;
+
+	//スクリーン座標の線を1本描く
+	//colorは0xRRGGBBAA
+	virtual void DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) = 0;
+};
+
+//通った線のハッシュ(FNV-1a)を取りながら次の出力先へ渡す
+//最適化の前後で出力が変わっていないかをリプレイで比べる用
+class ChecksumLineSink : public LineSink {
+public:
+	explicit ChecksumLineSink(LineSink *next = nullptr) : next_(next) {}
+
+	void DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) override {
+		Mix(uint32_t(x1));
+		Mix(uint32_t(y1));
+		Mix(uint32_t(x2));
+		Mix(uint32_t(y2));
+		Mix(color);
+		if (next_) {
+			next_->DrawLine(x1 , y1 , x2 , y2 , color);
+		}
+	}
+
+	//最初からの線全部のハッシュ
+	uint64_t GetChecksum() const { return checksum_; }
+
+private:
+	void Mix(uint32_t value) {
+		for (int i = 0; i < 4; ++i) {
+			checksum_ ^= (value >> (i * 8)) & 0xFF;
+			checksum_ *= 1099511628211ull;
+		}
+	}
+
+	LineSink *next_;
+	uint64_t checksum_ = 14695981039346656037ull;
+};
@@ -0,0 +1,640 @@
+#include "MyMath.h"
+#define _USE_MATH_DEFINES
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+Vec3 Add(const Vec3 &v1 , const Vec3 &v2) {
+	Vec3 result;
+	result.x = v1.x + v2.x;
+	result.y = v1.y + v2.y;
+	result.z = v1.z + v2.z;
+	return result;
+}
+
+Vec3 Subtract(const Vec3 &v1 , const Vec3 &v2) {
+	Vec3 result;
+	result.x = v1.x - v2.x;
+	result.y = v1.y - v2.y;
+	result.z = v1.z - v2.z;
+	return result;
+}
+
+Vec3 MultiplyVec3(float scaler , const Vec3 &v) {
+	Vec3 result;
+	result.x = v.x * scaler;
+	result.y = v.y * scaler;
+	result.z = v.z * scaler;
+	return result;
+}
+
+Matrix4x4 Multiply(const Matrix4x4 &matrix1 , const Matrix4x4 &matrix2) {
+	Matrix4x4 result;
+
+#if defined(__SSE2__) || defined(_M_X64)
+	//結果の1行 = matrix1の行の各要素 × matrix2の各行 の和
+	__m128 row0 = _mm_loadu_ps(matrix2.m[0]);
+	__m128 row1 = _mm_loadu_ps(matrix2.m[1]);
+	__m128 row2 = _mm_loadu_ps(matrix2.m[2]);
+	__m128 row3 = _mm_loadu_ps(matrix2.m[3]);
+
+	for (int i = 0; i < 4; ++i) {
+		__m128 sum = _mm_mul_ps(_mm_set1_ps(matrix1.m[i][0]) , row0);
+		sum = _mm_add_ps(sum , _mm_mul_ps(_mm_set1_ps(matrix1.m[i][1]) , row1));
+		sum = _mm_add_ps(sum , _mm_mul_ps(_mm_set1_ps(matrix1.m[i][2]) , row2));
+		sum = _mm_add_ps(sum , _mm_mul_ps(_mm_set1_ps(matrix1.m[i][3]) , row3));
+		_mm_storeu_ps(result.m[i] , sum);
+	}
+#else
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			result.m[i][j] = 0;
+			for (int k = 0; k < 4; ++k) {
+				result.m[i][j] += matrix1.m[i][k] * matrix2.m[k][j];
+			}
+		}
+	}
+#endif
+
+	return result;
+}
+
+Matrix4x4 MultiplyLeftAffine(const Matrix4x4 &matrix1 , const Matrix4x4 &matrix2) {
+	Matrix4x4 result;
+
+#if defined(__SSE2__) || defined(_M_X64)
+	__m128 row0 = _mm_loadu_ps(matrix2.m[0]);
+	__m128 row1 = _mm_loadu_ps(matrix2.m[1]);
+	__m128 row2 = _mm_loadu_ps(matrix2.m[2]);
+	__m128 row3 = _mm_loadu_ps(matrix2.m[3]);
+
+	for (int i = 0; i < 4; ++i) {
+		__m128 sum = _mm_mul_ps(_mm_set1_ps(matrix1.m[i][0]) , row0);
+		sum = _mm_add_ps(sum , _mm_mul_ps(_mm_set1_ps(matrix1.m[i][1]) , row1));
+		sum = _mm_add_ps(sum , _mm_mul_ps(_mm_set1_ps(matrix1.m[i][2]) , row2));
+		//4列目は(0,0,0,1)なので4行目にだけそのまま足す
+		if (i == 3) {
+			sum = _mm_add_ps(sum , row3);
+		}
+		_mm_storeu_ps(result.m[i] , sum);
+	}
+#else
+	result = MultiplyLeftAffineConstexpr(matrix1 , matrix2);
+#endif
+
+	return result;
+}
+
+Matrix4x4 MakeRotateXMatrix(float radian) {
+	Matrix4x4 result;
+
+	result = MakeIdentity4x4();
+
+	result.m[1][1] = std::cos(radian);
+	result.m[1][2] = std::sin(radian);
+	result.m[2][1] = -std::sin(radian);
+	result.m[2][2] = std::cos(radian);
+
+	return result;
+}
+
+Matrix4x4 MakeRotateYMatrix(float radian) {
+	Matrix4x4 result;
+
+	result = MakeIdentity4x4();
+
+	result.m[0][0] = std::cos(radian);
+	result.m[0][2] = -std::sin(radian);
+	result.m[2][0] = std::sin(radian);
+	result.m[2][2] = std::cos(radian);
+
+	return result;
+}
+
+Matrix4x4 MakeRotateZMatrix(float radian) {
+	Matrix4x4 result;
+
+	result = MakeIdentity4x4();
+
+	result.m[0][0] = std::cos(radian);
+	result.m[0][1] = std::sin(radian);
+	result.m[1][0] = -std::sin(radian);
+	result.m[1][1] = std::cos(radian);
+
+	return result;
+}
+
+Matrix4x4 MakeRotateMatrix(const Vec3 &rotate) {
+	float cx = std::cos(rotate.x);
+	float sx = std::sin(rotate.x);
+	float cy = std::cos(rotate.y);
+	float sy = std::sin(rotate.y);
+	float cz = std::cos(rotate.z);
+	float sz = std::sin(rotate.z);
+
+	Matrix4x4 matrix;
+	matrix.m[0][0] = cy * cz;
+	matrix.m[0][1] = cy * sz;
+	matrix.m[0][2] = -sy;
+	matrix.m[0][3] = 0.0f;
+	matrix.m[1][0] = sx * sy * cz - cx * sz;
+	matrix.m[1][1] = sx * sy * sz + cx * cz;
+	matrix.m[1][2] = sx * cy;
+	matrix.m[1][3] = 0.0f;
+	matrix.m[2][0] = cx * sy * cz + sx * sz;
+	matrix.m[2][1] = cx * sy * sz - sx * cz;
+	matrix.m[2][2] = cx * cy;
+	matrix.m[2][3] = 0.0f;
+	matrix.m[3][0] = 0.0f;
+	matrix.m[3][1] = 0.0f;
+	matrix.m[3][2] = 0.0f;
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
+
+Vec3 Transform(const Vec3& vector, const Matrix4x4 &matrix) {
+	Vec3 result;
+	// 各成分を計算
+	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + matrix.m[3][0];
+	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + matrix.m[3][1];
+	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + matrix.m[3][2];
+	float w = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + matrix.m[3][3];
+
+	if (w != 0.0f) {
+		result.x /= w;
+		result.y /= w;
+		result.z /= w;
+	}
+
+	return result;
+}
+
+void TransformBatch(const float *inX , const float *inY , const float *inZ , size_t count , const Matrix4x4 &matrix , float *outX , float *outY , float *outZ) {
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	{
+		__m256 m[4][4];
+		for (int r = 0; r < 4; ++r) {
+			for (int c = 0; c < 4; ++c) {
+				m[r][c] = _mm256_set1_ps(matrix.m[r][c]);
+			}
+		}
+		const __m256 zero = _mm256_setzero_ps();
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(inX + i);
+			__m256 y = _mm256_loadu_ps(inY + i);
+			__m256 z = _mm256_loadu_ps(inZ + i);
+
+			__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x , m[0][0]) , _mm256_mul_ps(y , m[1][0])) , _mm256_mul_ps(z , m[2][0])) , m[3][0]);
+			__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x , m[0][1]) , _mm256_mul_ps(y , m[1][1])) , _mm256_mul_ps(z , m[2][1])) , m[3][1]);
+			__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x , m[0][2]) , _mm256_mul_ps(y , m[1][2])) , _mm256_mul_ps(z , m[2][2])) , m[3][2]);
+			__m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x , m[0][3]) , _mm256_mul_ps(y , m[1][3])) , _mm256_mul_ps(z , m[2][3])) , m[3][3]);
+
+			//w == 0 の頂点は割らない
+			__m256 mask = _mm256_cmp_ps(w , zero , _CMP_NEQ_UQ);
+			_mm256_storeu_ps(outX + i , _mm256_blendv_ps(rx , _mm256_div_ps(rx , w) , mask));
+			_mm256_storeu_ps(outY + i , _mm256_blendv_ps(ry , _mm256_div_ps(ry , w) , mask));
+			_mm256_storeu_ps(outZ + i , _mm256_blendv_ps(rz , _mm256_div_ps(rz , w) , mask));
+		}
+	}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	{
+		__m128 m[4][4];
+		for (int r = 0; r < 4; ++r) {
+			for (int c = 0; c < 4; ++c) {
+				m[r][c] = _mm_set1_ps(matrix.m[r][c]);
+			}
+		}
+		const __m128 zero = _mm_setzero_ps();
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(inX + i);
+			__m128 y = _mm_loadu_ps(inY + i);
+			__m128 z = _mm_loadu_ps(inZ + i);
+
+			__m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x , m[0][0]) , _mm_mul_ps(y , m[1][0])) , _mm_mul_ps(z , m[2][0])) , m[3][0]);
+			__m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x , m[0][1]) , _mm_mul_ps(y , m[1][1])) , _mm_mul_ps(z , m[2][1])) , m[3][1]);
+			__m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x , m[0][2]) , _mm_mul_ps(y , m[1][2])) , _mm_mul_ps(z , m[2][2])) , m[3][2]);
+			__m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x , m[0][3]) , _mm_mul_ps(y , m[1][3])) , _mm_mul_ps(z , m[2][3])) , m[3][3]);
+
+			//w == 0 の頂点は割らない(SSE2にblendvは無いのでand/andnotで選ぶ)
+			__m128 mask = _mm_cmpneq_ps(w , zero);
+			_mm_storeu_ps(outX + i , _mm_or_ps(_mm_and_ps(mask , _mm_div_ps(rx , w)) , _mm_andnot_ps(mask , rx)));
+			_mm_storeu_ps(outY + i , _mm_or_ps(_mm_and_ps(mask , _mm_div_ps(ry , w)) , _mm_andnot_ps(mask , ry)));
+			_mm_storeu_ps(outZ + i , _mm_or_ps(_mm_and_ps(mask , _mm_div_ps(rz , w)) , _mm_andnot_ps(mask , rz)));
+		}
+	}
+#endif
+
+	//残りはスカラーで
+	for (; i < count; ++i) {
+		Vec3 result = Transform({inX[i], inY[i], inZ[i]} , matrix);
+		outX[i] = result.x;
+		outY[i] = result.y;
+		outZ[i] = result.z;
+	}
+}
+
+void TransformBatch(const Vec3Array &in , const Matrix4x4 &matrix , Vec3Array &out) {
+	out.resize(in.size());
+	TransformBatch(in.x.data() , in.y.data() , in.z.data() , in.size() , matrix , out.x.data() , out.y.data() , out.z.data());
+}
+
+Matrix4x4 MakeAffineMatrix(const Vec3 &scale , const Vec3 &rotate , const Vec3 &translate) {
+	Matrix4x4 matrix = MakeRotateMatrix(rotate);
+
+	for (int j = 0; j < 3; ++j) {
+		matrix.m[0][j] *= scale.x;
+		matrix.m[1][j] *= scale.y;
+		matrix.m[2][j] *= scale.z;
+	}
+	matrix.m[3][0] = translate.x;
+	matrix.m[3][1] = translate.y;
+	matrix.m[3][2] = translate.z;
+
+	return matrix;
+}
+
+Quaternion Multiply(const Quaternion &lhs , const Quaternion &rhs) {
+	Quaternion result;
+	result.w = lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z;
+	result.x = lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y;
+	result.y = lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x;
+	result.z = lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w;
+	return result;
+}
+
+Quaternion MakeQuaternionFromEuler(const Vec3 &rotate) {
+	Quaternion qx = {std::sin(rotate.x / 2.0f), 0.0f, 0.0f, std::cos(rotate.x / 2.0f)};
+	Quaternion qy = {0.0f, std::sin(rotate.y / 2.0f), 0.0f, std::cos(rotate.y / 2.0f)};
+	Quaternion qz = {0.0f, 0.0f, std::sin(rotate.z / 2.0f), std::cos(rotate.z / 2.0f)};
+	return Multiply(qz , Multiply(qy , qx));
+}
+
+Matrix4x4 MakeRotateMatrixFromQuaternion(const Quaternion &q) {
+	float xx = q.x * q.x;
+	float yy = q.y * q.y;
+	float zz = q.z * q.z;
+	float xy = q.x * q.y;
+	float xz = q.x * q.z;
+	float yz = q.y * q.z;
+	float wx = q.w * q.x;
+	float wy = q.w * q.y;
+	float wz = q.w * q.z;
+
+	Matrix4x4 matrix;
+	matrix.m[0][0] = 1.0f - 2.0f * (yy + zz);
+	matrix.m[0][1] = 2.0f * (xy + wz);
+	matrix.m[0][2] = 2.0f * (xz - wy);
+	matrix.m[0][3] = 0.0f;
+	matrix.m[1][0] = 2.0f * (xy - wz);
+	matrix.m[1][1] = 1.0f - 2.0f * (xx + zz);
+	matrix.m[1][2] = 2.0f * (yz + wx);
+	matrix.m[1][3] = 0.0f;
+	matrix.m[2][0] = 2.0f * (xz + wy);
+	matrix.m[2][1] = 2.0f * (yz - wx);
+	matrix.m[2][2] = 1.0f - 2.0f * (xx + yy);
+	matrix.m[2][3] = 0.0f;
+	matrix.m[3][0] = 0.0f;
+	matrix.m[3][1] = 0.0f;
+	matrix.m[3][2] = 0.0f;
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
+
+Matrix4x4 MakeAffineMatrixFromQuaternion(const Vec3 &scale , const Quaternion &rotate , const Vec3 &translate) {
+	Matrix4x4 matrix = MakeRotateMatrixFromQuaternion(rotate);
+
+	for (int j = 0; j < 3; ++j) {
+		matrix.m[0][j] *= scale.x;
+		matrix.m[1][j] *= scale.y;
+		matrix.m[2][j] *= scale.z;
+	}
+	matrix.m[3][0] = translate.x;
+	matrix.m[3][1] = translate.y;
+	matrix.m[3][2] = translate.z;
+
+	return matrix;
+}
+
+const Matrix4x4 &GetWorldMatrix(QuaternionTransform &transform) {
+	if (transform.isDirty) {
+		transform.matrix = MakeAffineMatrixFromQuaternion(transform.scale , transform.rotate , transform.translate);
+		transform.isDirty = false;
+	}
+	return transform.matrix;
+}
+
+Matrix4x4 MakePerspectiveFovMatrix(float fovY , float aspectRatio , float nearClip , float farClip) {
+	Matrix4x4 matrix;
+	matrix.m[0][0] = 1.0f / aspectRatio * (1.0f / std::tan(fovY / 2.0f));
+	matrix.m[0][1] = 0.0f;
+	matrix.m[0][2] = 0.0f;
+	matrix.m[0][3] = 0.0f;
+	matrix.m[1][0] = 0.0f;
+	matrix.m[1][1] = 1.0f / std::tan(fovY / 2.0f);
+	matrix.m[1][2] = 0.0f;
+	matrix.m[1][3] = 0.0f;
+	matrix.m[2][0] = 0.0f;
+	matrix.m[2][1] = 0.0f;
+	matrix.m[2][2] = farClip / (farClip - nearClip);
+	matrix.m[2][3] = 1.0f;
+	matrix.m[3][0] = 0.0f;
+	matrix.m[3][1] = 0.0f;
+	matrix.m[3][2] = (-nearClip * farClip) / (farClip - nearClip);
+	matrix.m[3][3] = 0.0f;
+
+	return matrix;
+}
+
+float Determinant(const Matrix4x4 &matrix) {
+	float det =
+		matrix.m[0][0] * (matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][3] +
+						  matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][1] +
+						  matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][2] -
+						  matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][1] -
+						  matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][2] -
+						  matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][3]) -
+		matrix.m[0][1] * (matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][3] +
+						  matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][0] +
+						  matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][2] -
+						  matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][0] -
+						  matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][2] -
+						  matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][3]) +
+		matrix.m[0][2] * (matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][3] +
+						  matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][0] +
+						  matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][1] -
+						  matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][0] -
+						  matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][1] -
+						  matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][3]) -
+		matrix.m[0][3] * (matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][2] +
+						  matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][0] +
+						  matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][1] -
+						  matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][0] -
+						  matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][1] -
+						  matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][2]);
+
+	return det;
+}
+
+Matrix4x4 Inverse(const Matrix4x4& matrix) {
+	Matrix4x4 result;
+
+	//先に余因子行列を作り、行列式はその1列目から求める
+	result.m[0][0] = (matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][3] +
+					  matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][1] +
+					  matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][2] -
+					  matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][1] -
+					  matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][2] -
+					  matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][3]);
+	result.m[0][1] = (-matrix.m[0][1] * matrix.m[2][2] * matrix.m[3][3] -
+					  matrix.m[0][2] * matrix.m[2][3] * matrix.m[3][1] -
+					  matrix.m[0][3] * matrix.m[2][1] * matrix.m[3][2] +
+					  matrix.m[0][3] * matrix.m[2][2] * matrix.m[3][1] +
+					  matrix.m[0][1] * matrix.m[2][3] * matrix.m[3][2] +
+					  matrix.m[0][2] * matrix.m[2][1] * matrix.m[3][3]);
+	result.m[0][2] = (matrix.m[0][1] * matrix.m[1][2] * matrix.m[3][3] +
+					  matrix.m[0][2] * matrix.m[1][3] * matrix.m[3][1] +
+					  matrix.m[0][3] * matrix.m[1][1] * matrix.m[3][2] -
+					  matrix.m[0][3] * matrix.m[1][2] * matrix.m[3][1] -
+					  matrix.m[0][1] * matrix.m[1][3] * matrix.m[3][2] -
+					  matrix.m[0][2] * matrix.m[1][1] * matrix.m[3][3]);
+	result.m[0][3] = (-matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][3] -
+					  matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][1] -
+					  matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][2] +
+					  matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][1] +
+					  matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][2] +
+					  matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][3]);
+
+	result.m[1][0] = (-matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][3] -
+					  matrix.m[1][2] * matrix.m[2][3] * matrix.m[3][0] -
+					  matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][2] +
+					  matrix.m[1][3] * matrix.m[2][2] * matrix.m[3][0] +
+					  matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][2] +
+					  matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][3]);
+	result.m[1][1] = (matrix.m[0][0] * matrix.m[2][2] * matrix.m[3][3] +
+					  matrix.m[0][2] * matrix.m[2][3] * matrix.m[3][0] +
+					  matrix.m[0][3] * matrix.m[2][0] * matrix.m[3][2] -
+					  matrix.m[0][3] * matrix.m[2][2] * matrix.m[3][0] -
+					  matrix.m[0][0] * matrix.m[2][3] * matrix.m[3][2] -
+					  matrix.m[0][2] * matrix.m[2][0] * matrix.m[3][3]);
+	result.m[1][2] = (-matrix.m[0][0] * matrix.m[1][2] * matrix.m[3][3] -
+					  matrix.m[0][2] * matrix.m[1][3] * matrix.m[3][0] -
+					  matrix.m[0][3] * matrix.m[1][0] * matrix.m[3][2] +
+					  matrix.m[0][3] * matrix.m[1][2] * matrix.m[3][0] +
+					  matrix.m[0][0] * matrix.m[1][3] * matrix.m[3][2] +
+					  matrix.m[0][2] * matrix.m[1][0] * matrix.m[3][3]);
+	result.m[1][3] = (matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][3] +
+					  matrix.m[0][2] * matrix.m[1][3] * matrix.m[2][0] +
+					  matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][2] -
+					  matrix.m[0][3] * matrix.m[1][2] * matrix.m[2][0] -
+					  matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][2] -
+					  matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][3]);
+
+	result.m[2][0] = (matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][3] +
+					  matrix.m[1][1] * matrix.m[2][3] * matrix.m[3][0] +
+					  matrix.m[1][3] * matrix.m[2][0] * matrix.m[3][1] -
+					  matrix.m[1][3] * matrix.m[2][1] * matrix.m[3][0] -
+					  matrix.m[1][0] * matrix.m[2][3] * matrix.m[3][1] -
+					  matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][3]);
+	result.m[2][1] = (-matrix.m[0][0] * matrix.m[2][1] * matrix.m[3][3] -
+					  matrix.m[0][1] * matrix.m[2][3] * matrix.m[3][0] -
+					  matrix.m[0][3] * matrix.m[2][0] * matrix.m[3][1] +
+					  matrix.m[0][3] * matrix.m[2][1] * matrix.m[3][0] +
+					  matrix.m[0][0] * matrix.m[2][3] * matrix.m[3][1] +
+					  matrix.m[0][1] * matrix.m[2][0] * matrix.m[3][3]);
+	result.m[2][2] = (matrix.m[0][0] * matrix.m[1][1] * matrix.m[3][3] +
+					  matrix.m[0][1] * matrix.m[1][3] * matrix.m[3][0] +
+					  matrix.m[0][3] * matrix.m[1][0] * matrix.m[3][1] -
+					  matrix.m[0][3] * matrix.m[1][1] * matrix.m[3][0] -
+					  matrix.m[0][0] * matrix.m[1][3] * matrix.m[3][1] -
+					  matrix.m[0][1] * matrix.m[1][0] * matrix.m[3][3]);
+	result.m[2][3] = (-matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][3] -
+					  matrix.m[0][1] * matrix.m[1][3] * matrix.m[2][0] -
+					  matrix.m[0][3] * matrix.m[1][0] * matrix.m[2][1] +
+					  matrix.m[0][3] * matrix.m[1][1] * matrix.m[2][0] +
+					  matrix.m[0][0] * matrix.m[1][3] * matrix.m[2][1] +
+					  matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][3]);
+
+	result.m[3][0] = (-matrix.m[1][0] * matrix.m[2][1] * matrix.m[3][2] -
+					  matrix.m[1][1] * matrix.m[2][2] * matrix.m[3][0] -
+					  matrix.m[1][2] * matrix.m[2][0] * matrix.m[3][1] +
+					  matrix.m[1][2] * matrix.m[2][1] * matrix.m[3][0] +
+					  matrix.m[1][0] * matrix.m[2][2] * matrix.m[3][1] +
+					  matrix.m[1][1] * matrix.m[2][0] * matrix.m[3][2]);
+	result.m[3][1] = (matrix.m[0][0] * matrix.m[2][1] * matrix.m[3][2] +
+					  matrix.m[0][1] * matrix.m[2][2] * matrix.m[3][0] +
+					  matrix.m[0][2] * matrix.m[2][0] * matrix.m[3][1] -
+					  matrix.m[0][2] * matrix.m[2][1] * matrix.m[3][0] -
+					  matrix.m[0][0] * matrix.m[2][2] * matrix.m[3][1] -
+					  matrix.m[0][1] * matrix.m[2][0] * matrix.m[3][2]);
+	result.m[3][2] = (-matrix.m[0][0] * matrix.m[1][1] * matrix.m[3][2] -
+					  matrix.m[0][1] * matrix.m[1][2] * matrix.m[3][0] -
+					  matrix.m[0][2] * matrix.m[1][0] * matrix.m[3][1] +
+					  matrix.m[0][2] * matrix.m[1][1] * matrix.m[3][0] +
+					  matrix.m[0][0] * matrix.m[1][2] * matrix.m[3][1] +
+					  matrix.m[0][1] * matrix.m[1][0] * matrix.m[3][2]);
+	result.m[3][3] = (matrix.m[0][0] * matrix.m[1][1] * matrix.m[2][2] +
+					  matrix.m[0][1] * matrix.m[1][2] * matrix.m[2][0] +
+					  matrix.m[0][2] * matrix.m[1][0] * matrix.m[2][1] -
+					  matrix.m[0][2] * matrix.m[1][1] * matrix.m[2][0] -
+					  matrix.m[0][0] * matrix.m[1][2] * matrix.m[2][1] -
+					  matrix.m[0][1] * matrix.m[1][0] * matrix.m[2][2]);
+
+	float det = matrix.m[0][0] * result.m[0][0] + matrix.m[0][1] * result.m[1][0] +
+				matrix.m[0][2] * result.m[2][0] + matrix.m[0][3] * result.m[3][0];
+	if (det == 0.0f) {
+		//逆行列が無いときは単位行列を返す
+		return MakeIdentity4x4();
+	}
+
+	float invDet = 1.0f / det;
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			result.m[i][j] *= invDet;
+		}
+	}
+
+	return result;
+}
+
+Matrix4x4 InverseAffine(const Matrix4x4 &matrix) {
+	//左上3x3の逆行列
+	float c00 = matrix.m[1][1] * matrix.m[2][2] - matrix.m[1][2] * matrix.m[2][1];
+	float c01 = matrix.m[1][2] * matrix.m[2][0] - matrix.m[1][0] * matrix.m[2][2];
+	float c02 = matrix.m[1][0] * matrix.m[2][1] - matrix.m[1][1] * matrix.m[2][0];
+	float det = matrix.m[0][0] * c00 + matrix.m[0][1] * c01 + matrix.m[0][2] * c02;
+	if (det == 0.0f) {
+		return MakeIdentity4x4();
+	}
+	float invDet = 1.0f / det;
+
+	Matrix4x4 result;
+	result.m[0][0] = c00 * invDet;
+	result.m[0][1] = (matrix.m[0][2] * matrix.m[2][1] - matrix.m[0][1] * matrix.m[2][2]) * invDet;
+	result.m[0][2] = (matrix.m[0][1] * matrix.m[1][2] - matrix.m[0][2] * matrix.m[1][1]) * invDet;
+	result.m[0][3] = 0.0f;
+	result.m[1][0] = c01 * invDet;
+	result.m[1][1] = (matrix.m[0][0] * matrix.m[2][2] - matrix.m[0][2] * matrix.m[2][0]) * invDet;
+	result.m[1][2] = (matrix.m[0][2] * matrix.m[1][0] - matrix.m[0][0] * matrix.m[1][2]) * invDet;
+	result.m[1][3] = 0.0f;
+	result.m[2][0] = c02 * invDet;
+	result.m[2][1] = (matrix.m[0][1] * matrix.m[2][0] - matrix.m[0][0] * matrix.m[2][1]) * invDet;
+	result.m[2][2] = (matrix.m[0][0] * matrix.m[1][1] - matrix.m[0][1] * matrix.m[1][0]) * invDet;
+	result.m[2][3] = 0.0f;
+
+	//平行移動は -t * (3x3の逆行列)
+	for (int j = 0; j < 3; ++j) {
+		result.m[3][j] = -(matrix.m[3][0] * result.m[0][j] + matrix.m[3][1] * result.m[1][j] + matrix.m[3][2] * result.m[2][j]);
+	}
+	result.m[3][3] = 1.0f;
+
+	return result;
+}
+
+Matrix4x4 InverseRigid(const Matrix4x4 &matrix) {
+	Matrix4x4 result;
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			result.m[i][j] = matrix.m[j][i];
+		}
+		result.m[i][3] = 0.0f;
+	}
+
+	for (int j = 0; j < 3; ++j) {
+		result.m[3][j] = -(matrix.m[3][0] * result.m[0][j] + matrix.m[3][1] * result.m[1][j] + matrix.m[3][2] * result.m[2][j]);
+	}
+	result.m[3][3] = 1.0f;
+
+	return result;
+}
+
+Vec4 TransformHomogeneous(const Vec3 &vector , const Matrix4x4 &matrix) {
+	Vec4 result;
+	result.x = vector.x * matrix.m[0][0] + vector.y * matrix.m[1][0] + vector.z * matrix.m[2][0] + matrix.m[3][0];
+	result.y = vector.x * matrix.m[0][1] + vector.y * matrix.m[1][1] + vector.z * matrix.m[2][1] + matrix.m[3][1];
+	result.z = vector.x * matrix.m[0][2] + vector.y * matrix.m[1][2] + vector.z * matrix.m[2][2] + matrix.m[3][2];
+	result.w = vector.x * matrix.m[0][3] + vector.y * matrix.m[1][3] + vector.z * matrix.m[2][3] + matrix.m[3][3];
+	return result;
+}
+
+void ProjectScaledBatch(const float *inX , const float *inY , const float *inW , size_t count , float scale , const Vec4 &offset , float *outX , float *outY) {
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	{
+		const __m256 s = _mm256_set1_ps(scale);
+		const __m256 ox = _mm256_set1_ps(offset.x);
+		const __m256 oy = _mm256_set1_ps(offset.y);
+		const __m256 ow = _mm256_set1_ps(offset.w);
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(inX + i) , s) , ox);
+			__m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(inY + i) , s) , oy);
+			__m256 w = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(inW + i) , s) , ow);
+			_mm256_storeu_ps(outX + i , _mm256_div_ps(x , w));
+			_mm256_storeu_ps(outY + i , _mm256_div_ps(y , w));
+		}
+	}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	{
+		const __m128 s = _mm_set1_ps(scale);
+		const __m128 ox = _mm_set1_ps(offset.x);
+		const __m128 oy = _mm_set1_ps(offset.y);
+		const __m128 ow = _mm_set1_ps(offset.w);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(inX + i) , s) , ox);
+			__m128 y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(inY + i) , s) , oy);
+			__m128 w = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(inW + i) , s) , ow);
+			_mm_storeu_ps(outX + i , _mm_div_ps(x , w));
+			_mm_storeu_ps(outY + i , _mm_div_ps(y , w));
+		}
+	}
+#endif
+
+	//残りはスカラーで
+	for (; i < count; ++i) {
+		float w = inW[i] * scale + offset.w;
+		outX[i] = (inX[i] * scale + offset.x) / w;
+		outY[i] = (inY[i] * scale + offset.y) / w;
+	}
+}
+
+bool IsSameVec3(const Vec3 &v1 , const Vec3 &v2) {
+	return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
+}
+
+Vec3 Perpendicular(const Vec3 &vector) {
+	if (vector.x != 0.0f || vector.y != 0.0f) {
+		return {-vector.y, vector.x, 0.0f};
+	}
+	return {0.0f, -vector.z, vector.y};
+}
+
+Vec3 Normalize(const Vec3 &v) {
+	Vec3 result;
+	float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+	return result = {v.x / length, v.y / length, v.z / length};
+}
+
+Vec3 Cross(const Vec3 &v1 , const Vec3 &v2) {
+	Vec3 result;
+	result.x = (v1.y * v2.z) - (v1.z * v2.y);
+	result.y = (v1.z * v2.x) - (v1.x * v2.z);
+	result.z = (v1.x * v2.y) - (v1.y * v2.x);
+	return result;
+}
+
+float Dot(const Vec3 &v1 , const Vec3 &v2) {
+	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
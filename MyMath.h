@@ -0,0 +1,351 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+//ベクトルと行列の計算(Noviceに依存しないのでLinuxでもそのままビルドできる)
+
+struct Vec3 {
+	float x;
+	float y;
+	float z;
+};
+
+struct Matrix4x4 {
+	float m[4][4];
+};
+
+struct Sphere {
+	Vec3 center;
+	float radius;
+};
+
+struct Plane {
+	Vec3 normal;
+	float distance;
+};
+
+//加算
+Vec3 Add(const Vec3 &v1 , const Vec3 &v2);
+
+//減算
+Vec3 Subtract(const Vec3 &v1 , const Vec3 &v2);
+
+//スカラー倍
+Vec3 MultiplyVec3(float scaler , const Vec3 &v);
+
+//単位行列の作成
+constexpr Matrix4x4 MakeIdentity4x4() {
+	Matrix4x4 result = {};
+
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			if (i == j) {
+				result.m[i][j] = 1.0f;
+			} else {
+				result.m[i][j] = 0.0f;
+			}
+		}
+	}
+
+	return result;
+}
+
+//行列の積
+Matrix4x4 Multiply(const Matrix4x4 &matrix1 , const Matrix4x4 &matrix2);
+
+//Scale
+constexpr Matrix4x4 MakeScaleMatrix(const Vec3 &scale) {
+	Matrix4x4 matrix = MakeIdentity4x4();
+
+	matrix.m[0][0] = scale.x;
+	matrix.m[1][1] = scale.y;
+	matrix.m[2][2] = scale.z;
+
+	return matrix;
+}
+
+//Rotate
+Matrix4x4 MakeRotateXMatrix(float radian);
+
+Matrix4x4 MakeRotateYMatrix(float radian);
+
+Matrix4x4 MakeRotateZMatrix(float radian);
+
+//X→Y→Zの順の回転(Rx * Ry * Rz を展開したもの)
+Matrix4x4 MakeRotateMatrix(const Vec3 &rotate);
+
+//Translate
+constexpr Matrix4x4 MakeTranslateMatrix(const Vec3 &translate) {
+	Matrix4x4 matrix = MakeIdentity4x4();
+
+	matrix.m[3][0] = translate.x;
+	matrix.m[3][1] = translate.y;
+	matrix.m[3][2] = translate.z;
+
+	return matrix;
+}
+
+//Transform
+Vec3 Transform(const Vec3& vector, const Matrix4x4 &matrix);
+
+//SoAの頂点配列
+struct Vec3Array {
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+
+	size_t size() const { return x.size(); }
+
+	void resize(size_t count) {
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	void push_back(const Vec3 &v) {
+		x.push_back(v.x);
+		y.push_back(v.y);
+		z.push_back(v.z);
+	}
+};
+
+//まとめてTransform(1頂点ずつのTransformと同じ式。FMAに縮約されるビルドでは最後の数桁が違うことがある。MyMathTest.cppで比べる)
+void TransformBatch(const float *inX , const float *inY , const float *inZ , size_t count , const Matrix4x4 &matrix , float *outX , float *outY , float *outZ);
+
+void TransformBatch(const Vec3Array &in , const Matrix4x4 &matrix , Vec3Array &out);
+
+//Affine
+//S * R * T は回転の各行をスケールして、4行目に平行移動を入れるだけ
+Matrix4x4 MakeAffineMatrix(const Vec3 &scale , const Vec3 &rotate , const Vec3 &translate);
+
+struct Quaternion {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+//クォータニオンの積(rhsの回転の後にlhsの回転)
+Quaternion Multiply(const Quaternion &lhs , const Quaternion &rhs);
+
+//オイラー角から(MakeRotateMatrixと同じX→Y→Zの順)
+Quaternion MakeQuaternionFromEuler(const Vec3 &rotate);
+
+//単位クォータニオンから回転行列
+//オイラー角の物と同じ名前にすると {0, 0, 0} を渡した時にどちらか決まらないので名前を分ける
+Matrix4x4 MakeRotateMatrixFromQuaternion(const Quaternion &q);
+
+Matrix4x4 MakeAffineMatrixFromQuaternion(const Vec3 &scale , const Quaternion &rotate , const Vec3 &translate);
+
+//クォータニオンで回転を持つTransform
+//値を変えたらisDirtyを立てる。変わっていない物は行列を作り直さない
+struct QuaternionTransform {
+	Vec3 scale;
+	Quaternion rotate;
+	Vec3 translate;
+	Matrix4x4 matrix;
+	bool isDirty;
+};
+
+const Matrix4x4 &GetWorldMatrix(QuaternionTransform &transform);
+
+//透視投影行列
+Matrix4x4 MakePerspectiveFovMatrix(float fovY , float aspectRatio , float nearClip , float farClip);
+
+//正射影行列
+constexpr Matrix4x4 MakeOrthographicMatrix(float left , float top , float right , float bottom , float nearClip , float farClip) {
+	Matrix4x4 matrix = {};
+	matrix.m[0][0] = 2.0f / (right - left);
+	matrix.m[0][1] = 0.0f;
+	matrix.m[0][2] = 0.0f;
+	matrix.m[0][3] = 0.0f;
+	matrix.m[1][0] = 0.0f;
+	matrix.m[1][1] = 2.0f / (top - bottom);
+	matrix.m[1][2] = 0.0f;
+	matrix.m[1][3] = 0.0f;
+	matrix.m[2][0] = 0.0f;
+	matrix.m[2][1] = 0.0f;
+	matrix.m[2][2] = 1.0f / (farClip - nearClip);
+	matrix.m[2][3] = 0.0f;
+	matrix.m[3][0] = (left + right) / (left - right);
+	matrix.m[3][1] = (top + bottom) / (bottom - top);
+	matrix.m[3][2] = nearClip / (nearClip - farClip);
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
+
+//ビューポート変換行列
+constexpr Matrix4x4 MakeViewportMatrix(float left , float top , float width , float height , float minDepth , float maxDepth) {
+	Matrix4x4 matrix = {};
+	matrix.m[0][0] = width / 2.0f;
+	matrix.m[0][1] = 0.0f;
+	matrix.m[0][2] = 0.0f;
+	matrix.m[0][3] = 0.0f;
+	matrix.m[1][0] = 0.0f;
+	matrix.m[1][1] = -(height / 2.0f);
+	matrix.m[1][2] = 0.0f;
+	matrix.m[1][3] = 0.0f;
+	matrix.m[2][0] = 0.0f;
+	matrix.m[2][1] = 0.0f;
+	matrix.m[2][2] = maxDepth - minDepth;
+	matrix.m[2][3] = 0.0f;
+	matrix.m[3][0] = left + (width / 2.0f);
+	matrix.m[3][1] = top + (height / 2.0f);
+	matrix.m[3][2] = minDepth;
+	matrix.m[3][3] = 1.0f;
+
+	return matrix;
+}
+
+// 行列式を計算する関数
+float Determinant(const Matrix4x4 &matrix);
+
+//逆行列
+Matrix4x4 Inverse(const Matrix4x4& matrix);
+
+//アフィン行列の逆行列(4列目が(0,0,0,1)の行列用)
+Matrix4x4 InverseAffine(const Matrix4x4 &matrix);
+
+//回転+平行移動だけの行列の逆行列(回転は転置、平行移動は逆向き)
+Matrix4x4 InverseRigid(const Matrix4x4 &matrix);
+
+struct Vec4 {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+//wで割らないTransform
+Vec4 TransformHomogeneous(const Vec3 &vector , const Matrix4x4 &matrix);
+
+//拡大+平行移動したインスタンスの頂点をまとめてwで割る
+//in は単位の頂点に行列の平行移動以外をかけておいたもの、offset はインスタンスの中心をTransformHomogeneousしたもの
+//out = (scale * in.xy + offset.xy) / (scale * in.w + offset.w) なのでインスタンスごとに行列を作らなくていい
+void ProjectScaledBatch(const float *inX , const float *inY , const float *inW , size_t count , float scale , const Vec4 &offset , float *outX , float *outY);
+
+//要素が全部同じか
+bool IsSameVec3(const Vec3 &v1 , const Vec3 &v2);
+
+//垂直なベクトル(正規化はしない)
+Vec3 Perpendicular(const Vec3 &vector);
+
+//正規化
+Vec3 Normalize(const Vec3 &v);
+
+//クロス積
+Vec3 Cross(const Vec3 &v1 , const Vec3 &v2);
+
+//内積
+float Dot(const Vec3 &v1 , const Vec3 &v2);
+
+//行列の種類のタグ(kRankが大きいほど一般的)
+//型で持っておくと、掛け算と変換でどこを省けるかをコンパイル時に選べる
+struct IdentityTag { static constexpr int kRank = 0; }; //単位行列
+struct TranslateTag { static constexpr int kRank = 1; }; //平行移動だけ
+struct AffineTag { static constexpr int kRank = 2; }; //4列目が(0,0,0,1)
+struct ProjectiveTag { static constexpr int kRank = 3; }; //透視投影など何でも
+
+template<typename Tag>
+struct TypedMatrix4x4 {
+	Matrix4x4 m;
+};
+
+using IdentityMatrix4x4 = TypedMatrix4x4<IdentityTag>;
+using TranslateMatrix4x4 = TypedMatrix4x4<TranslateTag>;
+using AffineMatrix4x4 = TypedMatrix4x4<AffineTag>;
+using ProjectiveMatrix4x4 = TypedMatrix4x4<ProjectiveTag>;
+
+//種類が分かっている行列にタグを付ける(中身は確かめない)
+template<typename Tag>
+constexpr TypedMatrix4x4<Tag> MakeTyped(const Matrix4x4 &matrix) {
+	return {matrix};
+}
+
+constexpr IdentityMatrix4x4 kIdentityMatrix = {MakeIdentity4x4()};
+
+//掛けた結果の種類は一般的な方になる
+template<int kRank>
+struct MatrixTagFromRank {
+	using Type = ProjectiveTag;
+};
+template<>
+struct MatrixTagFromRank<0> {
+	using Type = IdentityTag;
+};
+template<>
+struct MatrixTagFromRank<1> {
+	using Type = TranslateTag;
+};
+template<>
+struct MatrixTagFromRank<2> {
+	using Type = AffineTag;
+};
+
+template<typename Tag1 , typename Tag2>
+using MultiplyTag = typename MatrixTagFromRank<(Tag1::kRank > Tag2::kRank ? Tag1::kRank : Tag2::kRank)>::Type;
+
+//左の行列の4列目が(0,0,0,1)と分かっている時の積(SSE)
+//省くのは0を掛ける項と1を掛ける項だけなので、結果はMultiplyと同じになる
+Matrix4x4 MultiplyLeftAffine(const Matrix4x4 &matrix1 , const Matrix4x4 &matrix2);
+
+//コンパイル時に計算する用
+constexpr Matrix4x4 MultiplyLeftAffineConstexpr(const Matrix4x4 &matrix1 , const Matrix4x4 &matrix2) {
+	Matrix4x4 result = {};
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			result.m[i][j] = matrix1.m[i][0] * matrix2.m[0][j] + matrix1.m[i][1] * matrix2.m[1][j] + matrix1.m[i][2] * matrix2.m[2][j];
+			if (i == 3) {
+				result.m[i][j] += matrix2.m[3][j];
+			}
+		}
+	}
+	return result;
+}
+
+//種類に合わせて省ける所を省いた積
+//単位行列は何もしない、平行移動同士は足すだけ、左がアフィンなら4行目との積を省く
+template<typename Tag1 , typename Tag2>
+constexpr TypedMatrix4x4<MultiplyTag<Tag1 , Tag2>> Multiply(const TypedMatrix4x4<Tag1> &matrix1 , const TypedMatrix4x4<Tag2> &matrix2) {
+	if constexpr (std::is_same_v<Tag1 , IdentityTag>) {
+		return {matrix2.m};
+	} else if constexpr (std::is_same_v<Tag2 , IdentityTag>) {
+		return {matrix1.m};
+	} else if constexpr (std::is_same_v<Tag1 , TranslateTag> && std::is_same_v<Tag2 , TranslateTag>) {
+		Matrix4x4 result = matrix1.m;
+		result.m[3][0] += matrix2.m.m[3][0];
+		result.m[3][1] += matrix2.m.m[3][1];
+		result.m[3][2] += matrix2.m.m[3][2];
+		return {result};
+	} else if constexpr (Tag1::kRank <= AffineTag::kRank) {
+		if (std::is_constant_evaluated()) {
+			return {MultiplyLeftAffineConstexpr(matrix1.m , matrix2.m)};
+		}
+		return {MultiplyLeftAffine(matrix1.m , matrix2.m)};
+	} else {
+		return {Multiply(matrix1.m , matrix2.m)};
+	}
+}
+
+//種類に合わせたTransform
+//単位行列はそのまま、平行移動は足すだけ、アフィンはwで割らない
+template<typename Tag>
+constexpr Vec3 Transform(const Vec3 &vector , const TypedMatrix4x4<Tag> &matrix) {
+	const Matrix4x4 &m = matrix.m;
+	if constexpr (std::is_same_v<Tag , IdentityTag>) {
+		return vector;
+	} else if constexpr (std::is_same_v<Tag , TranslateTag>) {
+		return {vector.x + m.m[3][0], vector.y + m.m[3][1], vector.z + m.m[3][2]};
+	} else if constexpr (std::is_same_v<Tag , AffineTag>) {
+		return {
+			vector.x * m.m[0][0] + vector.y * m.m[1][0] + vector.z * m.m[2][0] + m.m[3][0],
+			vector.x * m.m[0][1] + vector.y * m.m[1][1] + vector.z * m.m[2][1] + m.m[3][1],
+			vector.x * m.m[0][2] + vector.y * m.m[1][2] + vector.z * m.m[2][2] + m.m[3][2]
+		};
+	} else {
+		return Transform(vector , m);
+	}
+}
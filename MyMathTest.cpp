@@ -0,0 +1,131 @@
+//TransformBatchを1頂点ずつのTransformとランダムな入力で比べる(CMakeLists.txtのctest)
+//MyMath.cppと同じフラグでビルドするので、-mavx2ならAVX2、x64ならSSE2の経路を確かめる
+#include "MyMath.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+//AVX2の経路なのにCPUが対応していない時はctestでスキップにする
+const int kSkipExitCode = 77;
+
+//掛け算と足し算の順番やFMAでの縮約で変わるのは最後の数桁だけ
+//値そのものではなく、足した項の大きさに対する相対誤差で比べる(打ち消し合って0に近い値でも誤差は項の大きさ分出る)
+const float kRelativeTolerance = 1.0e-5f;
+
+const char *GetPathName() {
+#if defined(__AVX2__)
+	return "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+//1成分分の誤差の大きさ(割る前の項の絶対値の和 / |w|)
+float GetErrorScale(const Vec3 &v , const Matrix4x4 &matrix , int column , float w) {
+	float sum = std::fabs(v.x * matrix.m[0][column]) + std::fabs(v.y * matrix.m[1][column]) + std::fabs(v.z * matrix.m[2][column]) + std::fabs(matrix.m[3][column]);
+	return w != 0.0f ? sum / std::fabs(w) : sum;
+}
+
+//wの誤差は割った後の値にも効くので、それも足す
+float GetTolerance(const Vec3 &v , const Matrix4x4 &matrix , int column , float expected) {
+	float w = v.x * matrix.m[0][3] + v.y * matrix.m[1][3] + v.z * matrix.m[2][3] + matrix.m[3][3];
+	float scale = GetErrorScale(v , matrix , column , w);
+	if (w != 0.0f) {
+		scale += std::fabs(expected) * GetErrorScale(v , matrix , 3 , w);
+	}
+	return kRelativeTolerance * std::fmax(scale , 1.0e-30f);
+}
+
+//戻り値は合わなかった数
+int CheckTransformBatch(const char *name , const Vec3Array &points , const Matrix4x4 &matrix , float &maxRelativeError) {
+	Vec3Array batch;
+	TransformBatch(points , matrix , batch);
+
+	int failureCount = 0;
+	for (size_t i = 0; i < points.size(); ++i) {
+		Vec3 v = {points.x[i], points.y[i], points.z[i]};
+		Vec3 expected = Transform(v , matrix);
+		float expectedValues[3] = {expected.x, expected.y, expected.z};
+		float actualValues[3] = {batch.x[i], batch.y[i], batch.z[i]};
+
+		for (int column = 0; column < 3; ++column) {
+			float tolerance = GetTolerance(v , matrix , column , expectedValues[column]);
+			float error = std::fabs(actualValues[column] - expectedValues[column]);
+			maxRelativeError = std::fmax(maxRelativeError , error / tolerance * kRelativeTolerance);
+			if (!(error <= tolerance)) {
+				if (failureCount < 10) {
+					std::fprintf(stderr , "%s: count %zu index %zu axis %d expected %.9g actual %.9g\n" , name , points.size() , i , column , expectedValues[column] , actualValues[column]);
+				}
+				++failureCount;
+			}
+		}
+	}
+	return failureCount;
+}
+
+} // namespace
+
+int main() {
+#if defined(__AVX2__) && defined(__GNUC__)
+	if (!__builtin_cpu_supports("avx2")) {
+		std::printf("TransformBatch: CPU has no AVX2, skipped\n");
+		return kSkipExitCode;
+	}
+#endif
+
+	std::mt19937 random(20240603);
+	std::uniform_real_distribution<float> position(-10.0f , 10.0f);
+	std::uniform_real_distribution<float> angle(-3.14f , 3.14f);
+	std::uniform_real_distribution<float> scale(0.1f , 5.0f);
+	std::uniform_real_distribution<float> depth(0.2f , 90.0f);
+
+	Matrix4x4 projectionMatrix = MakePerspectiveFovMatrix(0.45f , 1280.0f / 720.0f , 0.1f , 100.0f);
+	Matrix4x4 viewportMatrix = MakeViewportMatrix(0 , 0 , 1280.0f , 720.0f , 0.0f , 1.0f);
+
+	//SIMDの幅で割り切れない数も混ぜて、端数のスカラーの所も通す
+	const size_t kCounts[] = {0 , 1 , 3 , 4 , 7 , 8 , 9 , 15 , 16 , 17 , 31 , 1000 , 1027};
+	const int kMatrixCount = 50;
+
+	int failureCount = 0;
+	float maxRelativeError = 0.0f;
+	for (int matrixIndex = 0; matrixIndex < kMatrixCount; ++matrixIndex) {
+		Vec3 s = {scale(random), scale(random), scale(random)};
+		Vec3 r = {angle(random), angle(random), angle(random)};
+		Vec3 t = {position(random), position(random), position(random)};
+		Matrix4x4 affineMatrix = MakeAffineMatrix(s , r , t);
+
+		//カメラの前に置いた点をビュープロジェクションビューポートで(wは奥行き)
+		Matrix4x4 camaraMatrix = MakeAffineMatrix({1.0f, 1.0f, 1.0f} , {angle(random) * 0.2f, angle(random), 0.0f} , t);
+		Matrix4x4 viewMatrix = Inverse(camaraMatrix);
+		Matrix4x4 screenMatrix = Multiply(Multiply(viewMatrix , projectionMatrix) , viewportMatrix);
+
+		//4列目が全部0ならwが0になり、割らずにそのまま返す
+		Matrix4x4 zeroWMatrix = affineMatrix;
+		for (int row = 0; row < 4; ++row) {
+			zeroWMatrix.m[row][3] = 0.0f;
+		}
+
+		for (size_t count : kCounts) {
+			Vec3Array points;
+			Vec3Array screenPoints;
+			for (size_t i = 0; i < count; ++i) {
+				points.push_back({position(random), position(random), position(random)});
+				//ビュー空間で前に置いてからワールドへ戻す
+				Vec3 viewPoint = {position(random), position(random) * 0.5f, depth(random)};
+				screenPoints.push_back(Transform(viewPoint , camaraMatrix));
+			}
+
+			failureCount += CheckTransformBatch("affine" , points , affineMatrix , maxRelativeError);
+			failureCount += CheckTransformBatch("perspective" , screenPoints , screenMatrix , maxRelativeError);
+			failureCount += CheckTransformBatch("zero w" , points , zeroWMatrix , maxRelativeError);
+		}
+	}
+
+	std::printf("TransformBatch (%s): max relative error %.3g , tolerance %.3g , failures %d\n" , GetPathName() , maxRelativeError , kRelativeTolerance , failureCount);
+	return failureCount == 0 ? 0 : 1;
+}
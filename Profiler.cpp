@@ -0,0 +1,89 @@
+#include "Profiler.h"
+#include <algorithm>
+
+Profiler *Profiler::GetInstance() {
+	static Profiler instance;
+	return &instance;
+}
+
+const char *Profiler::GetStageName(ProfileStage stage) {
+	static const char *const kNames[kProfileStageCount] = {"update", "collision", "geometry", "submission"};
+	return kNames[stage];
+}
+
+const char *Profiler::GetCounterName(ProfileCounter counter) {
+	static const char *const kNames[kProfileCounterCount] = {"matrices", "inverses", "vertices", "lines"};
+	return kNames[counter];
+}
+
+void Profiler::AddStageTime(ProfileStage stage , float milliseconds) {
+	currentStageMilliseconds_[stage] += milliseconds;
+}
+
+void Profiler::EndFrame() {
+	uint64_t frame = frameCount_.load(std::memory_order_relaxed);
+	FrameRecord &record = history_[frame % kHistorySize];
+
+	record.frame = frame;
+	for (int i = 0; i < kProfileStageCount; ++i) {
+		record.stageMilliseconds[i] = currentStageMilliseconds_[i];
+		currentStageMilliseconds_[i] = 0.0f;
+	}
+	for (int i = 0; i < kProfileCounterCount; ++i) {
+		record.counters[i] = counters_[i].exchange(0 , std::memory_order_relaxed);
+	}
+
+	//書き終わってから数を進める(読む側はこの数までしか見ない)
+	frameCount_.store(frame + 1 , std::memory_order_release);
+}
+
+const Profiler::FrameRecord &Profiler::GetLatestRecord() const {
+	uint64_t frameCount = frameCount_.load(std::memory_order_acquire);
+	return history_[(frameCount + kHistorySize - 1) % kHistorySize];
+}
+
+uint32_t Profiler::CopyStageHistory(ProfileStage stage , float *output , uint32_t outputSize) const {
+	uint64_t frameCount = frameCount_.load(std::memory_order_acquire);
+	uint64_t count = std::min<uint64_t>({frameCount , kHistorySize , outputSize});
+
+	for (uint64_t i = 0; i < count; ++i) {
+		uint64_t frame = frameCount - count + i;
+		output[i] = history_[frame % kHistorySize].stageMilliseconds[stage];
+	}
+	return uint32_t(count);
+}
+
+float Profiler::GetStagePercentile(ProfileStage stage , float percentile) const {
+	float values[kHistorySize];
+	uint32_t count = CopyStageHistory(stage , values , kHistorySize);
+	if (count == 0) {
+		return 0.0f;
+	}
+
+	uint32_t index = uint32_t(float(count - 1) * std::clamp(percentile , 0.0f , 100.0f) / 100.0f);
+	std::nth_element(values , values + index , values + count);
+	return values[index];
+}
+
+void Profiler::WriteCSVHeader(FILE *file) {
+	std::fprintf(file , "frame");
+	for (int i = 0; i < kProfileStageCount; ++i) {
+		std::fprintf(file , ",%s_ms" , GetStageName(ProfileStage(i)));
+	}
+	for (int i = 0; i < kProfileCounterCount; ++i) {
+		std::fprintf(file , ",%s" , GetCounterName(ProfileCounter(i)));
+	}
+	std::fprintf(file , "\n");
+}
+
+void Profiler::WriteCSVRow(FILE *file) const {
+	const FrameRecord &record = GetLatestRecord();
+	std::fprintf(file , "%llu" , static_cast<unsigned long long>(record.frame));
+	for (int i = 0; i < kProfileStageCount; ++i) {
+		std::fprintf(file , ",%.4f" , record.stageMilliseconds[i]);
+	}
+	for (int i = 0; i < kProfileCounterCount; ++i) {
+		std::fprintf(file , ",%llu" , static_cast<unsigned long long>(record.counters[i]));
+	}
+	std::fprintf(file , "\n");
+}
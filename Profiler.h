@@ -0,0 +1,115 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+//計測する処理の区間
+enum ProfileStage {
+	kProfileUpdate ,
+	kProfileCollision ,
+	kProfileGeometry ,
+	kProfileSubmission ,
+	kProfileStageCount
+};
+
+//フレームごとに数える物
+enum ProfileCounter {
+	kProfileMatrices , //作った行列
+	kProfileInverses , //逆行列
+	kProfileVertices , //変換した頂点
+	kProfileLines , //出した線
+	kProfileCounterCount
+};
+
+//描画スレッドで1フレーム分のカウンタを数えておく所(RenderContextに持たせる)
+//Profilerに足すのは線を受け取ったメインスレッドなので、latencyが1でも数えたスナップショットのフレームに入る
+struct ProfileCounterBlock {
+	std::atomic<uint64_t> values[kProfileCounterCount] = {};
+
+	void Add(ProfileCounter counter , uint64_t value) {
+		values[counter].fetch_add(value , std::memory_order_relaxed);
+	}
+};
+
+//区間ごとの時間とカウンタを直近のフレーム分だけリングバッファに残す
+class Profiler {
+public:
+	static constexpr uint32_t kHistorySize = 256;
+
+	//1フレーム分の記録
+	struct FrameRecord {
+		uint64_t frame;
+		float stageMilliseconds[kProfileStageCount];
+		uint64_t counters[kProfileCounterCount];
+	};
+
+	static Profiler *GetInstance();
+
+	//区間の時間を足す(メインスレッドから)
+	void AddStageTime(ProfileStage stage , float milliseconds);
+
+	//カウンタを足す(どのスレッドからでもよい)
+	void AddCount(ProfileCounter counter , uint64_t value) {
+		counters_[counter].fetch_add(value , std::memory_order_relaxed);
+	}
+
+	//描画スレッドで数えた分をまとめて足す
+	void AddCounts(const uint64_t (&values)[kProfileCounterCount]) {
+		for (int i = 0; i < kProfileCounterCount; ++i) {
+			AddCount(ProfileCounter(i) , values[i]);
+		}
+	}
+
+	//今のフレームの値をリングバッファに書いてリセットする
+	void EndFrame();
+
+	//直近のフレームでの区間時間のパーセンタイル(0～100)
+	float GetStagePercentile(ProfileStage stage , float percentile) const;
+
+	//直近に終わったフレーム
+	const FrameRecord &GetLatestRecord() const;
+
+	//区間時間の履歴を古い順に並べる(グラフ用)
+	//戻り値は並べた数
+	uint32_t CopyStageHistory(ProfileStage stage , float *output , uint32_t outputSize) const;
+
+	//ImGuiのウィンドウに表示する(ProfilerImGui.cpp。Noviceのビルドだけ)
+	void DrawImGui() const;
+
+	//CSVの見出し行を書く
+	static void WriteCSVHeader(FILE *file);
+
+	//直近に終わったフレームをCSVの1行で書く
+	void WriteCSVRow(FILE *file) const;
+
+	static const char *GetStageName(ProfileStage stage);
+	static const char *GetCounterName(ProfileCounter counter);
+
+private:
+	Profiler() = default;
+
+	std::array<FrameRecord , kHistorySize> history_ = {};
+	std::atomic<uint64_t> frameCount_ = 0; //書き終わったフレーム数
+	float currentStageMilliseconds_[kProfileStageCount] = {};
+	std::atomic<uint64_t> counters_[kProfileCounterCount] = {};
+};
+
+//スコープの間の時間を区間に足す
+class ProfileScope {
+public:
+	explicit ProfileScope(ProfileStage stage) : stage_(stage) , start_(std::chrono::steady_clock::now()) {}
+
+	~ProfileScope() {
+		std::chrono::duration<float , std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+		Profiler::GetInstance()->AddStageTime(stage_ , elapsed.count());
+	}
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+	ProfileStage stage_;
+	std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,26 @@
+//ImGuiの表示だけはNoviceのビルドでしか使えないので分ける
+#include "Profiler.h"
+#include <imgui.h>
+
+void Profiler::DrawImGui() const {
+	ImGui::Begin("Profiler");
+
+	for (int i = 0; i < kProfileStageCount; ++i) {
+		ProfileStage stage = ProfileStage(i);
+		ImGui::Text(
+			"%-10s p50 %6.3fms  p95 %6.3fms  p99 %6.3fms" , GetStageName(stage) ,
+			GetStagePercentile(stage , 50.0f) , GetStagePercentile(stage , 95.0f) , GetStagePercentile(stage , 99.0f)
+		);
+
+		float history[kHistorySize];
+		uint32_t count = CopyStageHistory(stage , history , kHistorySize);
+		ImGui::PlotLines(GetStageName(stage) , history , int(count));
+	}
+
+	const FrameRecord &record = GetLatestRecord();
+	for (int i = 0; i < kProfileCounterCount; ++i) {
+		ImGui::Text("%-10s %llu" , GetCounterName(ProfileCounter(i)) , static_cast<unsigned long long>(record.counters[i]));
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,595 @@
+//M_PIを使うので最初に
+#define _USE_MATH_DEFINES
+#include "Render.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace {
+
+//描画スレッドから呼ぶ所はRenderContextのカウンタに数える
+void AddRenderCount(const RenderContext &context , ProfileCounter counter , uint64_t value) {
+	if (context.counters) {
+		context.counters->Add(counter , value);
+	} else {
+		Profiler::GetInstance()->AddCount(counter , value);
+	}
+}
+
+//無限グリッドの線の間隔(細かい順)
+const float kGridSpacings[] = {1.0f , 10.0f , 100.0f};
+//それぞれの間隔の線はカメラからこの本数分の距離までだけ引く(遠くは粗い線だけになる)
+const float kGridLineCountPerLevel = 10.0f;
+
+//単位球のメッシュ(分割数ごとに1回だけ作る)
+struct SphereMesh {
+	uint32_t subdivision;
+	Vec3Array vertices; //[latIndex * subdivision + lonIndex]
+	std::vector<uint32_t> edges; //2つで1本の線
+};
+
+SphereMesh MakeUnitSphereMesh(uint32_t subdivision) {
+	SphereMesh mesh;
+	mesh.subdivision = subdivision;
+
+	const float kLonEvery = (2.0f * float(M_PI)) / float(subdivision);
+	const float kLatEvery = float(M_PI) / float(subdivision);
+
+	//緯度は両端を含むので subdivision + 1 本
+	for (uint32_t latIndex = 0; latIndex <= subdivision; ++latIndex) {
+		float lat = float(M_PI) / 2.0f + kLatEvery * latIndex; //緯度
+
+		for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+			float lon = lonIndex * kLonEvery; //経度
+			mesh.vertices.push_back({std::cos(lat) * std::cos(lon), std::sin(lat), std::cos(lat) * std::sin(lon)});
+		}
+	}
+
+	mesh.edges.reserve(subdivision * subdivision * 4);
+	for (uint32_t latIndex = 0; latIndex < subdivision; ++latIndex) {
+		for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+			uint32_t a = latIndex * subdivision + lonIndex;
+			uint32_t b = (latIndex + 1) * subdivision + lonIndex;
+			uint32_t c = latIndex * subdivision + (lonIndex + 1) % subdivision;
+
+			//a,b
+			mesh.edges.push_back(a);
+			mesh.edges.push_back(b);
+
+			//a, c
+			mesh.edges.push_back(a);
+			mesh.edges.push_back(c);
+		}
+	}
+
+	return mesh;
+}
+
+const SphereMesh &GetUnitSphereMesh(uint32_t subdivision) {
+	//前回と同じ分割数ならロックしない
+	thread_local const SphereMesh *lastMesh = nullptr;
+	if (lastMesh && lastMesh->subdivision == subdivision) {
+		return *lastMesh;
+	}
+
+	//ジオメトリは並列に作るのでキャッシュはロックして触る(mapの要素の参照は消えない)
+	static std::mutex mutex;
+	static std::map<uint32_t , SphereMesh> cache;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = cache.find(subdivision);
+	if (it == cache.end()) {
+		it = cache.emplace(subdivision , MakeUnitSphereMesh(subdivision)).first;
+	}
+	lastMesh = &it->second;
+	return it->second;
+}
+
+//画面上の半径(ピクセル)から分割数を選ぶ
+uint32_t SelectSphereLOD(float screenRadius) {
+	if (screenRadius < 1.5f) {
+		return kSphereLODPoint;
+	}
+	if (screenRadius < 4.0f) {
+		return kSphereLODCircle;
+	}
+	if (screenRadius < 16.0f) {
+		return 6;
+	}
+	if (screenRadius < 48.0f) {
+		return 8;
+	}
+	if (screenRadius < 160.0f) {
+		return 12;
+	}
+	return 16;
+}
+
+//単位球の頂点に、ビュープロジェクションビューポート行列の平行移動以外をかけておいたもの
+//中心c・半径rの球の頂点は r * (x, y, z, w) + TransformHomogeneous(c) になるので、インスタンスごとに行列を作らなくていい
+struct ProjectedSphereMesh {
+	const SphereMesh *mesh = nullptr;
+	Matrix4x4 matrix; //変換に使った行列(変わったら作り直す)
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> w;
+};
+
+const ProjectedSphereMesh &GetProjectedSphereMesh(uint32_t subdivision , const RenderContext &context) {
+	const Matrix4x4 &matrix = context.viewProjectionViewportMatrix;
+	//行列はカメラが動くと変わるので、スレッドごとに持ってロックしない
+	thread_local std::map<uint32_t , ProjectedSphereMesh> cache;
+	ProjectedSphereMesh &projected = cache[subdivision];
+	if (projected.mesh && std::memcmp(&projected.matrix , &matrix , sizeof(Matrix4x4)) == 0) {
+		return projected;
+	}
+
+	const SphereMesh &mesh = GetUnitSphereMesh(subdivision);
+	Matrix4x4 linearMatrix = matrix;
+	for (int j = 0; j < 4; ++j) {
+		linearMatrix.m[3][j] = 0.0f;
+	}
+
+	size_t count = mesh.vertices.size();
+	projected.x.resize(count);
+	projected.y.resize(count);
+	projected.z.resize(count);
+	projected.w.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		Vec4 vertex = TransformHomogeneous({mesh.vertices.x[i], mesh.vertices.y[i], mesh.vertices.z[i]} , linearMatrix);
+		projected.x[i] = vertex.x;
+		projected.y[i] = vertex.y;
+		projected.z[i] = vertex.z;
+		projected.w[i] = vertex.w;
+	}
+	projected.mesh = &mesh;
+	projected.matrix = matrix;
+
+	AddRenderCount(context , kProfileMatrices , 1);
+	AddRenderCount(context , kProfileVertices , count);
+	return projected;
+}
+
+//裏側の線を消して球を描く(DrawSphereInstancesから呼ぶ)
+//単位球の頂点はそのまま法線なので、dot(法線 , axis) > threshold の頂点がカメラから見える
+//axisは中心からカメラへの単位ベクトル、thresholdは 半径 / カメラまでの距離(カメラは球の外にあること)
+//戻り値は変換した頂点の数
+size_t DrawSphereHiddenLine(const ProjectedSphereMesh &projected , const Sphere &sphere , const Vec4 &center , const Vec3 &axis , float threshold , const RenderContext &context , uint32_t color) {
+	const Vec3Array &normals = projected.mesh->vertices;
+	const std::vector<uint32_t> &edges = projected.mesh->edges;
+	size_t count = normals.size();
+	float radius = sphere.radius;
+
+	auto transformVertex = [&](size_t i) -> Vec4 {
+		return {
+			projected.x[i] * radius + center.x,
+			projected.y[i] * radius + center.y,
+			projected.z[i] * radius + center.z,
+			projected.w[i] * radius + center.w
+		};
+	};
+
+	//ニアクリップ面にかかっている球だけ線ごとに切る。それ以外は全部の頂点がニアクリップ面より前なのでwで割るだけ
+	bool isCrossingNear = SignedDistance(sphere.center , context.frustum.planes[kFrustumNear]) < radius;
+	auto drawLine = [&](const Vec4 &start , const Vec4 &end) {
+		if (isCrossingNear) {
+			DrawClippedLine(*context.lineSink , start , end , context.nearClip , color);
+			return;
+		}
+		context.lineSink->DrawLine(
+			int(start.x / start.w) , int(start.y / start.w) ,
+			int(end.x / end.w) , int(end.y / end.w) ,
+			color
+		);
+	};
+
+	//切る時は見える側の頂点だけを変換する。切らない時はまとめて画面に出す
+	thread_local std::vector<float> sides;
+	thread_local std::vector<Vec4> clipVertices;
+	thread_local std::vector<float> screenX;
+	thread_local std::vector<float> screenY;
+	sides.resize(count);
+	size_t transformedCount = 0;
+	for (size_t i = 0; i < count; ++i) {
+		sides[i] = normals.x[i] * axis.x + normals.y[i] * axis.y + normals.z[i] * axis.z - threshold;
+	}
+	if (isCrossingNear) {
+		clipVertices.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			if (sides[i] >= 0.0f) {
+				clipVertices[i] = transformVertex(i);
+				++transformedCount;
+			}
+		}
+	} else {
+		screenX.resize(count);
+		screenY.resize(count);
+		ProjectScaledBatch(projected.x.data() , projected.y.data() , projected.w.data() , count , radius , center , screenX.data() , screenY.data());
+		transformedCount += count;
+	}
+
+	for (size_t i = 0; i < edges.size(); i += 2) {
+		uint32_t start = edges[i];
+		uint32_t end = edges[i + 1];
+		bool isStartVisible = sides[start] >= 0.0f;
+		bool isEndVisible = sides[end] >= 0.0f;
+		if (!isStartVisible && !isEndVisible) {
+			continue;
+		}
+		if (isStartVisible && isEndVisible) {
+			if (isCrossingNear) {
+				DrawClippedLine(*context.lineSink , clipVertices[start] , clipVertices[end] , context.nearClip , color);
+			} else {
+				context.lineSink->DrawLine(
+					int(screenX[start]) , int(screenY[start]) ,
+					int(screenX[end]) , int(screenY[end]) ,
+					color
+				);
+			}
+			continue;
+		}
+
+		//片方だけ見える線はシルエットの円の面で切る(同次座標は位置に線形なのでそのまま補間できる)
+		uint32_t front = isStartVisible ? start : end;
+		uint32_t back = isStartVisible ? end : start;
+		float t = sides[front] / (sides[front] - sides[back]);
+		Vec4 frontVertex = isCrossingNear ? clipVertices[front] : transformVertex(front);
+		Vec4 backVertex = transformVertex(back);
+		++transformedCount;
+		Vec4 clipped = {
+			frontVertex.x + (backVertex.x - frontVertex.x) * t,
+			frontVertex.y + (backVertex.y - frontVertex.y) * t,
+			frontVertex.z + (backVertex.z - frontVertex.z) * t,
+			frontVertex.w + (backVertex.w - frontVertex.w) * t
+		};
+		if (isCrossingNear) {
+			DrawClippedLine(*context.lineSink , frontVertex , clipped , context.nearClip , color);
+		} else {
+			//見える側の端は隣の線と同じ点になるように、まとめて出した画面の座標を使う
+			context.lineSink->DrawLine(
+				int(screenX[front]) , int(screenY[front]) ,
+				int(clipped.x / clipped.w) , int(clipped.y / clipped.w) ,
+				color
+			);
+		}
+	}
+
+	//シルエットは、中心からaxis方向に 半径 * threshold の所にある 半径 * sqrt(1 - threshold^2) の円
+	Vec3 circleCenter = Add(sphere.center , MultiplyVec3(radius * threshold , axis));
+	float circleRadius = radius * std::sqrt(1.0f - threshold * threshold);
+	Vec3 tangent = Normalize(Perpendicular(axis));
+	Vec3 bitangent = Cross(axis , tangent);
+	uint32_t segmentCount = projected.mesh->subdivision * 2;
+	Vec4 previous = TransformHomogeneous(Add(circleCenter , MultiplyVec3(circleRadius , tangent)) , context.viewProjectionViewportMatrix);
+	for (uint32_t i = 1; i <= segmentCount; ++i) {
+		float angle = 2.0f * float(M_PI) * float(i) / float(segmentCount);
+		Vec3 offset = Add(MultiplyVec3(std::cos(angle) * circleRadius , tangent) , MultiplyVec3(std::sin(angle) * circleRadius , bitangent));
+		Vec4 current = TransformHomogeneous(Add(circleCenter , offset) , context.viewProjectionViewportMatrix);
+		drawLine(previous , current);
+		previous = current;
+	}
+	return transformedCount + segmentCount;
+}
+
+} // namespace
+
+bool ClipLineToNear(Vec4 &start , Vec4 &end , float nearClip) {
+	bool isStartInside = start.w >= nearClip;
+	bool isEndInside = end.w >= nearClip;
+	if (!isStartInside && !isEndInside) {
+		return false;
+	}
+	if (isStartInside && isEndInside) {
+		return true;
+	}
+
+	float t = (nearClip - start.w) / (end.w - start.w);
+	Vec4 clipped = {
+		start.x + (end.x - start.x) * t,
+		start.y + (end.y - start.y) * t,
+		start.z + (end.z - start.z) * t,
+		nearClip
+	};
+	if (isStartInside) {
+		end = clipped;
+	} else {
+		start = clipped;
+	}
+	return true;
+}
+
+void DrawClippedLine(LineSink &lineSink , Vec4 start , Vec4 end , float nearClip , uint32_t color) {
+	if (!ClipLineToNear(start , end , nearClip)) {
+		return;
+	}
+	lineSink.DrawLine(
+		int(start.x / start.w) , int(start.y / start.w) ,
+		int(end.x / end.w) , int(end.y / end.w) ,
+		color
+	);
+}
+
+RenderContext MakeRenderContext(const Matrix4x4 &projectionMatrix , const Matrix4x4 &viewportMatrix , LineSink *lineSink) {
+	assert(lineSink);
+	RenderContext context;
+	context.camaraTranslate = {0.0f, 0.0f, 0.0f};
+	context.camaraRotate = {0.0f, 0.0f, 0.0f};
+	context.projectionMatrix = projectionMatrix;
+	context.viewportMatrix = viewportMatrix;
+	context.viewMatrix = MakeIdentity4x4();
+	context.viewProjectionMatrix = projectionMatrix;
+	context.viewProjectionViewportMatrix = Multiply(projectionMatrix , viewportMatrix);
+	context.inverseViewProjectionMatrix = Inverse(projectionMatrix);
+	context.frustum = MakeFrustum(projectionMatrix);
+	//MakePerspectiveFovMatrixの m[3][2] = -n*f/(f-n) , m[2][2] = f/(f-n) から
+	context.nearClip = -projectionMatrix.m[3][2] / projectionMatrix.m[2][2];
+	//縦方向: m[1][1] = 1/tan(fovY/2) と ビューポートの高さ/2
+	context.pixelsPerUnitAtDepth1 = projectionMatrix.m[1][1] * std::fabs(viewportMatrix.m[1][1]);
+	context.lineSink = lineSink;
+	context.counters = nullptr;
+	context.isSphereHiddenLine = false;
+	context.isDeduplicateLines = false;
+	context.isDirty = true;
+	return context;
+}
+
+void UpdateRenderContext(RenderContext &context , const Vec3 &translate , const Vec3 &rotate) {
+	if (!context.isDirty && IsSameVec3(context.camaraTranslate , translate) && IsSameVec3(context.camaraRotate , rotate)) {
+		return;
+	}
+
+	context.camaraTranslate = translate;
+	context.camaraRotate = rotate;
+
+	//カメラはスケール1なので回転の転置で逆行列が作れる
+	Matrix4x4 camaraMatrix = MakeAffineMatrix({1.0f, 1.0f, 1.0f} , rotate , translate);
+	context.viewMatrix = InverseRigid(camaraMatrix);
+	//ビューとビューポートはアフィンなので4列目の計算を省ける
+	context.viewProjectionMatrix = Multiply(MakeTyped<AffineTag>(context.viewMatrix) , MakeTyped<ProjectiveTag>(context.projectionMatrix)).m;
+	context.viewProjectionViewportMatrix = Multiply(MakeTyped<ProjectiveTag>(context.viewProjectionMatrix) , MakeTyped<AffineTag>(context.viewportMatrix)).m;
+	context.inverseViewProjectionMatrix = Inverse(context.viewProjectionMatrix);
+	context.frustum = MakeFrustum(context.viewProjectionMatrix);
+	context.isDirty = false;
+
+	AddRenderCount(context , kProfileMatrices , 3);
+	AddRenderCount(context , kProfileInverses , 2);
+}
+
+void DrawGrid(const RenderContext &context) {
+	//視錐台の8つの角(射影はzが0～1)
+	Vec3 corners[8];
+	for (int i = 0; i < 8; ++i) {
+		Vec3 clip = {(i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f};
+		corners[i] = Transform(clip , context.inverseViewProjectionMatrix);
+	}
+
+	//視錐台の12本の辺とy = 0 の交点を囲む範囲だけを引く
+	float minX = INFINITY;
+	float maxX = -INFINITY;
+	float minZ = INFINITY;
+	float maxZ = -INFINITY;
+	for (int i = 0; i < 8; ++i) {
+		for (int axis = 1; axis < 8; axis <<= 1) {
+			if (i & axis) {
+				continue;
+			}
+			const Vec3 &a = corners[i];
+			const Vec3 &b = corners[i | axis];
+			if ((a.y < 0.0f) == (b.y < 0.0f) && a.y != 0.0f) {
+				continue;
+			}
+			float t = a.y == b.y ? 0.0f : a.y / (a.y - b.y);
+			float x = a.x + (b.x - a.x) * t;
+			float z = a.z + (b.z - a.z) * t;
+			minX = std::fmin(minX , x);
+			maxX = std::fmax(maxX , x);
+			minZ = std::fmin(minZ , z);
+			maxZ = std::fmax(maxZ , z);
+		}
+	}
+	//平面が見えていない
+	if (minX > maxX) {
+		return;
+	}
+
+	const Vec3 &camara = context.camaraTranslate;
+	float height = std::fabs(camara.y);
+	const size_t kLevelCount = sizeof(kGridSpacings) / sizeof(kGridSpacings[0]);
+	uint32_t lineCount = 0;
+
+	for (size_t level = 0; level < kLevelCount; ++level) {
+		float spacing = kGridSpacings[level];
+		//カメラからの距離がradiusまでの所だけ。高く離れたら細かい間隔は引かない
+		float radius = spacing * kGridLineCountPerLevel;
+		if (height >= radius) {
+			continue;
+		}
+		float halfWidth = std::sqrt(radius * radius - height * height);
+		float lowX = std::fmax(minX , camara.x - halfWidth);
+		float highX = std::fmin(maxX , camara.x + halfWidth);
+		float lowZ = std::fmax(minZ , camara.z - halfWidth);
+		float highZ = std::fmin(maxZ , camara.z + halfWidth);
+		if (lowX > highX || lowZ > highZ) {
+			continue;
+		}
+
+		//次の粗い間隔と重なる線はそちらで長く引くので飛ばす
+		int64_t coarseRatio = level + 1 < kLevelCount ? int64_t(kGridSpacings[level + 1] / spacing) : 0;
+
+		//Grid縦線(xが一定)
+		for (int64_t index = int64_t(std::ceil(lowX / spacing)); float(index) * spacing <= highX; ++index) {
+			if (coarseRatio != 0 && index % coarseRatio == 0) {
+				continue;
+			}
+			float x = float(index) * spacing;
+			Vec4 start = TransformHomogeneous({x, 0.0f, lowZ} , context.viewProjectionViewportMatrix);
+			Vec4 end = TransformHomogeneous({x, 0.0f, highZ} , context.viewProjectionViewportMatrix);
+			//原点を通る線は黒
+			DrawClippedLine(*context.lineSink , start , end , context.nearClip , index == 0 ? kColorBlack : kColorWhite);
+			++lineCount;
+		}
+
+		//Grid横線(zが一定)
+		for (int64_t index = int64_t(std::ceil(lowZ / spacing)); float(index) * spacing <= highZ; ++index) {
+			if (coarseRatio != 0 && index % coarseRatio == 0) {
+				continue;
+			}
+			float z = float(index) * spacing;
+			Vec4 start = TransformHomogeneous({lowX, 0.0f, z} , context.viewProjectionViewportMatrix);
+			Vec4 end = TransformHomogeneous({highX, 0.0f, z} , context.viewProjectionViewportMatrix);
+			DrawClippedLine(*context.lineSink , start , end , context.nearClip , index == 0 ? kColorBlack : kColorWhite);
+			++lineCount;
+		}
+	}
+
+	AddRenderCount(context , kProfileVertices , 8 + lineCount * 2);
+}
+
+uint32_t DrawSphereInstances(std::span<const SphereInstance> instances , const RenderContext &context , uint32_t subdivision) {
+	const Matrix4x4 &matrix = context.viewProjectionViewportMatrix;
+	thread_local std::vector<float> screenX;
+	thread_local std::vector<float> screenY;
+	thread_local std::vector<Vec4> clipVertices;
+
+	uint32_t drawnCount = 0;
+	size_t vertexCount = 0;
+	for (const SphereInstance &instance : instances) {
+		const Sphere &sphere = instance.sphere;
+		uint32_t color = instance.color;
+		if (!IsSphereInFrustum(sphere , context.frustum)) {
+			continue;
+		}
+		++drawnCount;
+
+		Vec4 center = TransformHomogeneous(sphere.center , matrix);
+		uint32_t instanceSubdivision = subdivision;
+
+		//ニアクリップ面にかかっている球は縮められないし、画面上の点や円にもできないので普通に描く
+		bool isBeyondNear = center.w - sphere.radius > context.nearClip;
+		if (!isBeyondNear && (instanceSubdivision == kSphereLODAuto || instanceSubdivision == kSphereLODPoint || instanceSubdivision == kSphereLODCircle)) {
+			instanceSubdivision = 12;
+		}
+		float screenRadius = isBeyondNear ? sphere.radius * context.pixelsPerUnitAtDepth1 / center.w : 0.0f;
+		if (instanceSubdivision == kSphereLODAuto) {
+			instanceSubdivision = SelectSphereLOD(screenRadius);
+		}
+
+		if (instanceSubdivision == kSphereLODPoint) {
+			int x = int(center.x / center.w);
+			int y = int(center.y / center.w);
+			context.lineSink->DrawLine(x , y , x , y , color);
+			continue;
+		}
+
+		if (instanceSubdivision == kSphereLODCircle) {
+			const int kCircleSegments = 8;
+			float x = center.x / center.w;
+			float y = center.y / center.w;
+			for (int i = 0; i < kCircleSegments; ++i) {
+				float angle1 = 2.0f * float(M_PI) * float(i) / float(kCircleSegments);
+				float angle2 = 2.0f * float(M_PI) * float(i + 1) / float(kCircleSegments);
+				context.lineSink->DrawLine(
+					int(x + std::cos(angle1) * screenRadius) , int(y + std::sin(angle1) * screenRadius) ,
+					int(x + std::cos(angle2) * screenRadius) , int(y + std::sin(angle2) * screenRadius) ,
+					color
+				);
+			}
+			continue;
+		}
+
+		//3未満では球の形にならない
+		instanceSubdivision = std::max(instanceSubdivision , kSphereMinSubdivision);
+
+		const ProjectedSphereMesh &projected = GetProjectedSphereMesh(instanceSubdivision , context);
+		const std::vector<uint32_t> &edges = projected.mesh->edges;
+		size_t count = projected.x.size();
+		float radius = sphere.radius;
+
+		//裏側を消すモードでは見える側の線とシルエットだけ(カメラが球の中なら全部見えるので普通に描く)
+		if (context.isSphereHiddenLine) {
+			Vec3 toCamara = Subtract(context.camaraTranslate , sphere.center);
+			float distance = std::sqrt(Dot(toCamara , toCamara));
+			if (distance > radius) {
+				vertexCount += DrawSphereHiddenLine(projected , sphere , center , MultiplyVec3(1.0f / distance , toCamara) , radius / distance , context , color);
+				continue;
+			}
+		}
+		vertexCount += count;
+
+		//ニアクリップ面にかかっている球は線ごとに切る
+		if (SignedDistance(sphere.center , context.frustum.planes[kFrustumNear]) < radius) {
+			clipVertices.resize(count);
+			for (size_t i = 0; i < count; ++i) {
+				clipVertices[i] = {
+					projected.x[i] * radius + center.x,
+					projected.y[i] * radius + center.y,
+					projected.z[i] * radius + center.z,
+					projected.w[i] * radius + center.w
+				};
+			}
+			for (size_t i = 0; i < edges.size(); i += 2) {
+				DrawClippedLine(*context.lineSink , clipVertices[edges[i]] , clipVertices[edges[i + 1]] , context.nearClip , color);
+			}
+			continue;
+		}
+
+		//頂点はまとめて1回ずつ変換する
+		screenX.resize(count);
+		screenY.resize(count);
+		ProjectScaledBatch(projected.x.data() , projected.y.data() , projected.w.data() , count , radius , center , screenX.data() , screenY.data());
+
+		for (size_t i = 0; i < edges.size(); i += 2) {
+			uint32_t start = edges[i];
+			uint32_t end = edges[i + 1];
+			context.lineSink->DrawLine(
+				int(screenX[start]) , int(screenY[start]) ,
+				int(screenX[end]) , int(screenY[end]) ,
+				color
+			);
+		}
+	}
+
+	//カウンタは全スレッドで共有なので最後に1回だけ足す
+	AddRenderCount(context , kProfileVertices , vertexCount);
+	return drawnCount;
+}
+
+bool DrawSphere(const Sphere &sphere , const RenderContext &context , uint32_t color , uint32_t subdivision) {
+	SphereInstance instance = {sphere, color};
+	return DrawSphereInstances({&instance , 1} , context , subdivision) != 0;
+}
+
+bool DrawPlane(const Plane &plane , const RenderContext &context , uint32_t color) {
+	Vec3 center = MultiplyVec3(plane.distance , plane.normal);
+
+	//描くのは中心から2.0の四角なので、それを囲む球で判定する
+	if (!IsSphereInFrustum({center , 2.0f} , context.frustum)) {
+		return false;
+	}
+
+	Vec3 perpendiculars[4];
+	perpendiculars[0] = Normalize(Perpendicular(plane.normal));
+	perpendiculars[1] = {-perpendiculars[0].x, -perpendiculars[0].y, -perpendiculars[0].z};
+	perpendiculars[2] = Cross(plane.normal , perpendiculars[0]);
+	perpendiculars[3] = {-perpendiculars[2].x, -perpendiculars[2].y, -perpendiculars[2].z};
+
+	//pointはもうワールド座標なのでワールド行列はかけない
+	AddRenderCount(context , kProfileVertices , 4);
+	Vec4 points[4];
+	for (int32_t index = 0; index < 4; ++index) {
+		Vec3 extend = MultiplyVec3(2.0f , perpendiculars[index]);
+		Vec3 point = Add(center , extend);
+		points[index] = TransformHomogeneous(point , context.viewProjectionViewportMatrix);
+	}
+
+	DrawClippedLine(*context.lineSink , points[1] , points[3] , context.nearClip , color);
+	DrawClippedLine(*context.lineSink , points[1] , points[2] , context.nearClip , color);
+	DrawClippedLine(*context.lineSink , points[2] , points[0] , context.nearClip , color);
+	DrawClippedLine(*context.lineSink , points[3] , points[0] , context.nearClip , color);
+	return true;
+}
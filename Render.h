@@ -0,0 +1,122 @@
+#pragma once
+#include "Collision.h"
+#include "JobSystem.h"
+#include "LineBatch.h"
+#include "LineSink.h"
+#include "MyMath.h"
+#include "Profiler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+//グリッド・球・平面を線にする(Noviceに依存しない)
+
+//線の色(0xRRGGBBAA。Noviceの WHITE , BLACK , RED と同じ値)
+const uint32_t kColorWhite = 0xFFFFFFFF;
+const uint32_t kColorBlack = 0x000000FF;
+const uint32_t kColorRed = 0xFF0000FF;
+
+//フレームごとの描画用行列
+struct RenderContext {
+	Vec3 camaraTranslate;
+	Vec3 camaraRotate;
+	Matrix4x4 projectionMatrix;
+	Matrix4x4 viewportMatrix;
+	Matrix4x4 viewMatrix;
+	Matrix4x4 viewProjectionMatrix;
+	Matrix4x4 viewProjectionViewportMatrix; //ワールド→スクリーン
+	Matrix4x4 inverseViewProjectionMatrix; //クリップ空間→ワールド(視錐台の角を出す用)
+	Frustum frustum; //ワールド空間
+	float nearClip;
+	float pixelsPerUnitAtDepth1; //奥行き1の所で長さ1が何ピクセルになるか
+	LineSink *lineSink; //線の出力先
+	ProfileCounterBlock *counters; //カウンタを数える所(nullならProfilerに直接足す)
+	bool isSphereHiddenLine; //球の裏側の線を消してシルエットの円を描く
+	bool isDeduplicateLines; //描き終わった線から同じ線を消す(色ごとに並べ変わるので重なる順番も変わる)
+	bool isDirty;
+};
+
+RenderContext MakeRenderContext(const Matrix4x4 &projectionMatrix , const Matrix4x4 &viewportMatrix , LineSink *lineSink);
+
+//カメラが動いた時だけ行列を作り直す
+void UpdateRenderContext(RenderContext &context , const Vec3 &translate , const Vec3 &rotate);
+
+//線分をニアクリップ面(w >= nearClip)で切る。全部後ろならfalse
+//透視投影ではwがビュー空間の奥行きなのでビューポートをかけた後でも使える
+bool ClipLineToNear(Vec4 &start , Vec4 &end , float nearClip);
+
+//ビューポートまでかけた同次座標の線分を切って描く
+void DrawClippedLine(LineSink &lineSink , Vec4 start , Vec4 end , float nearClip , uint32_t color);
+
+//Grid
+//y = 0 の無限グリッドのうち、視錐台に入る所だけを引く
+//カメラからの距離で間隔を1 , 10 , 100と変えるので、どれだけ離れても線の数は一定以下になる
+void DrawGrid(const RenderContext &context);
+
+//DrawSphereの分割数の特別な値(本当の分割数と重ならない値にする)
+const uint32_t kSphereLODAuto = 0; //画面上の大きさから選ぶ
+const uint32_t kSphereLODPoint = UINT32_MAX; //点1つ
+const uint32_t kSphereLODCircle = UINT32_MAX - 1; //画面上の円
+//これより小さい分割数はこれにする
+const uint32_t kSphereMinSubdivision = 3;
+
+//インスタンス描画の1つ分
+struct SphereInstance {
+	Sphere sphere;
+	uint32_t color;
+};
+
+//Sphere
+//球をまとめて描く。メッシュは分割数ごとに共有して、インスタンスごとには拡大+平行移動を足すだけ
+//subdivisionがkSphereLODAutoなら画面上の大きさで分割数を変える
+//戻り値は描いた数(視錐台の外の球は数えない)
+uint32_t DrawSphereInstances(std::span<const SphereInstance> instances , const RenderContext &context , uint32_t subdivision = kSphereLODAuto);
+
+//1個だけ描く
+//視錐台の外で描かなかったらfalse
+bool DrawSphere(const Sphere &sphere , const RenderContext &context , uint32_t color , uint32_t subdivision = kSphereLODAuto);
+
+//
+//視錐台の外で描かなかったらfalse
+bool DrawPlane(const Plane &plane , const RenderContext &context , uint32_t color);
+
+//count個の物をチャンクに分けて並列に線へ変換する
+//チャンクごとにLineBatchを持ち、チャンク順にoutputへつなげるのでスレッド数が変わっても出力は同じ
+//drawChunkFunc(begin, end, context)は[begin, end)を描いて描いた数を返す。戻り値は描いた数の合計
+//チャンク用のバッチはoutputが持つので、outputが別なら違うスレッドから同時に呼んでもよい
+template<typename DrawChunkFunc>
+uint32_t DrawParallelChunks(JobSystem &jobSystem , const RenderContext &context , size_t count , LineBatch &output , DrawChunkFunc drawChunkFunc) {
+	const size_t kChunkSize = 64;
+	size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+	std::vector<LineBatch> &chunkBatches = output.GetChunkBatches(chunkCount);
+
+	std::atomic<uint32_t> drawnCount = 0;
+	jobSystem.ParallelFor(count , kChunkSize , [&](size_t begin , size_t end , size_t chunkIndex) {
+		RenderContext chunkContext = context;
+		chunkContext.lineSink = &chunkBatches[chunkIndex];
+		drawnCount += drawChunkFunc(begin , end , chunkContext);
+	});
+
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+		output.Append(chunkBatches[chunkIndex]);
+		chunkBatches[chunkIndex].Clear();
+	}
+	return drawnCount;
+}
+
+//1個ずつ描く版
+//drawFunc(index, context)は描いたらtrue、カリングしたらfalseを返す。戻り値は描いた数
+template<typename DrawFunc>
+uint32_t DrawParallel(JobSystem &jobSystem , const RenderContext &context , size_t count , LineBatch &output , DrawFunc drawFunc) {
+	return DrawParallelChunks(jobSystem , context , count , output , [&](size_t begin , size_t end , const RenderContext &chunkContext) {
+		uint32_t chunkDrawnCount = 0;
+		for (size_t index = begin; index < end; ++index) {
+			if (drawFunc(index , chunkContext)) {
+				++chunkDrawnCount;
+			}
+		}
+		return chunkDrawnCount;
+	});
+}
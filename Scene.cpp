@@ -0,0 +1,354 @@
+#include "Scene.h"
+#include <assert.h>
+
+namespace {
+
+void InitializeArena(Arena &arena , size_t size) {
+	arena.buffer = std::make_unique<uint8_t[]>(size);
+	arena.size = size;
+	arena.offset = 0;
+}
+
+//64byte境界にそろえて切り出す
+template<typename T>
+T *AllocateFromArena(Arena &arena , size_t count) {
+	const size_t kAlignment = 64;
+	uintptr_t base = reinterpret_cast<uintptr_t>(arena.buffer.get());
+	size_t alignedOffset = ((base + arena.offset + kAlignment - 1) & ~uintptr_t(kAlignment - 1)) - base;
+	assert(alignedOffset + sizeof(T) * count <= arena.size);
+	arena.offset = alignedOffset + sizeof(T) * count;
+	return reinterpret_cast<T *>(arena.buffer.get() + alignedOffset);
+}
+
+template<size_t kColumnCount>
+size_t GetPoolArenaSize(uint32_t capacity) {
+	//各配列の分 + 配列ごとに境界合わせの余白(64byte未満)
+	const size_t kArrayCount = kColumnCount + 6;
+	return (sizeof(float) * kColumnCount + sizeof(uint32_t) * 6) * capacity + 64 * kArrayCount;
+}
+
+template<size_t kColumnCount>
+void InitializePool(SoAPool<kColumnCount> &pool , Arena &arena , uint32_t capacity) {
+	pool.capacity = capacity;
+	pool.count = 0;
+	for (size_t i = 0; i < kColumnCount; ++i) {
+		pool.columns[i] = AllocateFromArena<float>(arena , capacity);
+	}
+	pool.colors = AllocateFromArena<uint32_t>(arena , capacity);
+	pool.denseToSlot = AllocateFromArena<uint32_t>(arena , capacity);
+	pool.slotToDense = AllocateFromArena<uint32_t>(arena , capacity);
+	pool.generations = AllocateFromArena<uint32_t>(arena , capacity);
+	pool.versions = AllocateFromArena<uint32_t>(arena , capacity);
+	pool.freeSlots = AllocateFromArena<uint32_t>(arena , capacity);
+
+	//空きslotは小さい番号から使う
+	pool.freeCount = capacity;
+	for (uint32_t i = 0; i < capacity; ++i) {
+		pool.generations[i] = 0;
+		pool.versions[i] = 0;
+		pool.freeSlots[i] = capacity - 1 - i;
+	}
+}
+
+template<size_t kColumnCount>
+bool IsValidHandle(const SoAPool<kColumnCount> &pool , SceneHandle handle) {
+	return handle.slot < pool.capacity && pool.generations[handle.slot] == handle.generation && pool.slotToDense[handle.slot] < pool.count;
+}
+
+template<size_t kColumnCount>
+SceneHandle AddToPool(SoAPool<kColumnCount> &pool , const float (&values)[kColumnCount] , uint32_t color) {
+	assert(pool.freeCount > 0);
+	uint32_t slot = pool.freeSlots[--pool.freeCount];
+	uint32_t dense = pool.count++;
+
+	for (size_t i = 0; i < kColumnCount; ++i) {
+		pool.columns[i][dense] = values[i];
+	}
+	pool.colors[dense] = color;
+	pool.denseToSlot[dense] = slot;
+	pool.slotToDense[slot] = dense;
+	++pool.versions[slot];
+	return {slot, pool.generations[slot]};
+}
+
+template<size_t kColumnCount>
+void RemoveFromPool(SoAPool<kColumnCount> &pool , SceneHandle handle) {
+	assert(IsValidHandle(pool , handle));
+	uint32_t dense = pool.slotToDense[handle.slot];
+	uint32_t last = --pool.count;
+
+	//末尾の物を空いた所へ移す
+	if (dense != last) {
+		for (size_t i = 0; i < kColumnCount; ++i) {
+			pool.columns[i][dense] = pool.columns[i][last];
+		}
+		pool.colors[dense] = pool.colors[last];
+		uint32_t movedSlot = pool.denseToSlot[last];
+		pool.denseToSlot[dense] = movedSlot;
+		pool.slotToDense[movedSlot] = dense;
+	}
+
+	++pool.generations[handle.slot];
+	++pool.versions[handle.slot];
+	pool.freeSlots[pool.freeCount++] = handle.slot;
+}
+
+//値が変わった時だけ書き込んでversionを進める
+template<size_t kColumnCount>
+void SetPoolValues(SoAPool<kColumnCount> &pool , SceneHandle handle , const float (&values)[kColumnCount]) {
+	assert(IsValidHandle(pool , handle));
+	uint32_t dense = pool.slotToDense[handle.slot];
+	bool isChanged = false;
+	for (size_t i = 0; i < kColumnCount; ++i) {
+		if (pool.columns[i][dense] != values[i]) {
+			pool.columns[i][dense] = values[i];
+			isChanged = true;
+		}
+	}
+	if (isChanged) {
+		++pool.versions[handle.slot];
+	}
+}
+
+//ペアの新しい結果を覚えて、出入りのイベントを出す
+void UpdatePairHit(SceneCollisionCache &cache , uint32_t sphereSlot , uint32_t planeSlot , bool isHit) {
+	uint64_t &word = cache.pairHits[sphereSlot * cache.pairWordCount + planeSlot / 64];
+	uint64_t bit = 1ull << (planeSlot % 64);
+	bool isPrevHit = (word & bit) != 0;
+	if (!isHit && !isPrevHit) {
+		return;
+	}
+
+	CollisionEventType type = kCollisionStay;
+	if (isHit && !isPrevHit) {
+		type = kCollisionEnter;
+		word |= bit;
+		++cache.hitCounts[sphereSlot];
+	} else if (!isHit && isPrevHit) {
+		type = kCollisionExit;
+		word &= ~bit;
+		--cache.hitCounts[sphereSlot];
+	}
+	cache.events.push_back({{sphereSlot, cache.sphereGenerations[sphereSlot]}, {planeSlot, cache.planeGenerations[planeSlot]}, type});
+}
+
+//versionが変わったslotに印を付ける。戻り値は印を付けた数
+template<size_t kColumnCount>
+uint32_t FindDirtySlots(const SoAPool<kColumnCount> &pool , std::vector<uint32_t> &versions , std::vector<uint8_t> &isDirty) {
+	uint32_t dirtyCount = 0;
+	for (uint32_t slot = 0; slot < pool.capacity; ++slot) {
+		isDirty[slot] = pool.versions[slot] != versions[slot];
+		if (isDirty[slot]) {
+			versions[slot] = pool.versions[slot];
+			++dirtyCount;
+		}
+	}
+	return dirtyCount;
+}
+
+//slotに今生きている物が入っているか(空いたslotのslotToDenseは古い値のまま残っている)
+template<size_t kColumnCount>
+bool IsAliveSlot(const SoAPool<kColumnCount> &pool , uint32_t slot) {
+	uint32_t dense = pool.slotToDense[slot];
+	return dense < pool.count && pool.denseToSlot[dense] == slot;
+}
+
+} // namespace
+
+void InitializeScene(Scene &scene , uint32_t sphereCapacity , uint32_t planeCapacity) {
+	InitializeArena(scene.arena , GetPoolArenaSize<4>(sphereCapacity) + GetPoolArenaSize<4>(planeCapacity));
+	InitializePool(scene.spheres , scene.arena , sphereCapacity);
+	InitializePool(scene.planes , scene.arena , planeCapacity);
+
+	SceneCollisionCache &cache = scene.collision;
+	cache.sphereVersions.assign(sphereCapacity , 0);
+	cache.planeVersions.assign(planeCapacity , 0);
+	cache.sphereGenerations.assign(sphereCapacity , 0);
+	cache.planeGenerations.assign(planeCapacity , 0);
+	cache.isSphereDirty.assign(sphereCapacity , 0);
+	cache.isPlaneDirty.assign(planeCapacity , 0);
+	cache.pairWordCount = GetHitMaskWordCount(planeCapacity);
+	cache.pairHits.assign(cache.pairWordCount * sphereCapacity , 0);
+	cache.hitCounts.assign(sphereCapacity , 0);
+	cache.events.clear();
+	cache.retestCount = 0;
+}
+
+SceneHandle AddSphere(Scene &scene , const Sphere &sphere , uint32_t color) {
+	return AddToPool(scene.spheres , {sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius} , color);
+}
+
+SceneHandle AddPlane(Scene &scene , const Plane &plane , uint32_t color) {
+	return AddToPool(scene.planes , {plane.normal.x, plane.normal.y, plane.normal.z, plane.distance} , color);
+}
+
+void RemoveSphere(Scene &scene , SceneHandle handle) {
+	RemoveFromPool(scene.spheres , handle);
+}
+
+void RemovePlane(Scene &scene , SceneHandle handle) {
+	RemoveFromPool(scene.planes , handle);
+}
+
+Sphere GetSphereAt(const Scene &scene , uint32_t index) {
+	const SoAPool<4> &pool = scene.spheres;
+	return {{pool.columns[0][index], pool.columns[1][index], pool.columns[2][index]}, pool.columns[3][index]};
+}
+
+Plane GetPlaneAt(const Scene &scene , uint32_t index) {
+	const SoAPool<4> &pool = scene.planes;
+	return {{pool.columns[0][index], pool.columns[1][index], pool.columns[2][index]}, pool.columns[3][index]};
+}
+
+Sphere GetSphere(const Scene &scene , SceneHandle handle) {
+	assert(IsValidHandle(scene.spheres , handle));
+	return GetSphereAt(scene , scene.spheres.slotToDense[handle.slot]);
+}
+
+Plane GetPlane(const Scene &scene , SceneHandle handle) {
+	assert(IsValidHandle(scene.planes , handle));
+	return GetPlaneAt(scene , scene.planes.slotToDense[handle.slot]);
+}
+
+void SetSphere(Scene &scene , SceneHandle handle , const Sphere &sphere) {
+	SetPoolValues(scene.spheres , handle , {sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius});
+}
+
+void SetPlane(Scene &scene , SceneHandle handle , const Plane &plane) {
+	SetPoolValues(scene.planes , handle , {plane.normal.x, plane.normal.y, plane.normal.z, plane.distance});
+}
+
+bool IsPairHit(const SceneCollisionCache &cache , uint32_t sphereSlot , uint32_t planeSlot) {
+	return (cache.pairHits[sphereSlot * cache.pairWordCount + planeSlot / 64] >> (planeSlot % 64)) & 1;
+}
+
+void UpdateSceneCollision(Scene &scene) {
+	SceneCollisionCache &cache = scene.collision;
+	const SoAPool<4> &spheres = scene.spheres;
+	const SoAPool<4> &planes = scene.planes;
+	cache.events.clear();
+	cache.retestCount = 0;
+
+	uint32_t dirtySphereCount = FindDirtySlots(spheres , cache.sphereVersions , cache.isSphereDirty);
+	uint32_t dirtyPlaneCount = FindDirtySlots(planes , cache.planeVersions , cache.isPlaneDirty);
+
+	//どちらも変わっていないペアは前の結果のままStay
+	for (uint32_t sphereSlot = 0; sphereSlot < spheres.capacity; ++sphereSlot) {
+		if (cache.hitCounts[sphereSlot] == 0 || cache.isSphereDirty[sphereSlot]) {
+			continue;
+		}
+		for (size_t word = 0; word < cache.pairWordCount; ++word) {
+			uint64_t bits = cache.pairHits[sphereSlot * cache.pairWordCount + word];
+			for (uint32_t bit = 0; bits != 0; ++bit, bits >>= 1) {
+				uint32_t planeSlot = uint32_t(word * 64 + bit);
+				if ((bits & 1) && !cache.isPlaneDirty[planeSlot]) {
+					cache.events.push_back({{sphereSlot, cache.sphereGenerations[sphereSlot]}, {planeSlot, cache.planeGenerations[planeSlot]}, kCollisionStay});
+				}
+			}
+		}
+	}
+
+	if (dirtySphereCount == 0 && dirtyPlaneCount == 0) {
+		return;
+	}
+
+	//消えた・入れ替わった物の当たりは前の世代のままExitにしてから世代を進める
+	for (uint32_t sphereSlot = 0; sphereSlot < spheres.capacity; ++sphereSlot) {
+		if (cache.isSphereDirty[sphereSlot] && cache.sphereGenerations[sphereSlot] != spheres.generations[sphereSlot]) {
+			for (uint32_t planeSlot = 0; planeSlot < planes.capacity; ++planeSlot) {
+				UpdatePairHit(cache , sphereSlot , planeSlot , false);
+			}
+			cache.sphereGenerations[sphereSlot] = spheres.generations[sphereSlot];
+		}
+	}
+	for (uint32_t planeSlot = 0; planeSlot < planes.capacity; ++planeSlot) {
+		if (cache.isPlaneDirty[planeSlot] && cache.planeGenerations[planeSlot] != planes.generations[planeSlot]) {
+			for (uint32_t sphereSlot = 0; sphereSlot < spheres.capacity; ++sphereSlot) {
+				UpdatePairHit(cache , sphereSlot , planeSlot , false);
+			}
+			cache.planeGenerations[planeSlot] = planes.generations[planeSlot];
+		}
+	}
+
+	//変わった球は全部の平面と判定し直す
+	for (uint32_t sphereSlot = 0; sphereSlot < spheres.capacity; ++sphereSlot) {
+		if (!cache.isSphereDirty[sphereSlot] || !IsAliveSlot(spheres , sphereSlot)) {
+			continue;
+		}
+		Sphere sphere = GetSphereAt(scene , spheres.slotToDense[sphereSlot]);
+		for (uint32_t planeSlot = 0; planeSlot < planes.capacity; ++planeSlot) {
+			if (IsAliveSlot(planes , planeSlot)) {
+				UpdatePairHit(cache , sphereSlot , planeSlot , IsSphereToPlaneCollision(sphere , GetPlaneAt(scene , planes.slotToDense[planeSlot])));
+				++cache.retestCount;
+			}
+		}
+	}
+
+	//変わった平面は変わっていない球とだけ判定し直す(変わった球とは上で済んでいる)
+	thread_local std::vector<float> signedDistances;
+	thread_local std::vector<uint64_t> hitMask;
+	signedDistances.resize(spheres.count);
+	hitMask.resize(GetHitMaskWordCount(spheres.count));
+	for (uint32_t planeSlot = 0; planeSlot < planes.capacity; ++planeSlot) {
+		if (!cache.isPlaneDirty[planeSlot] || !IsAliveSlot(planes , planeSlot)) {
+			continue;
+		}
+		TestSpheresToPlane(
+			spheres.columns[0] , spheres.columns[1] , spheres.columns[2] , spheres.columns[3] , spheres.count ,
+			GetPlaneAt(scene , planes.slotToDense[planeSlot]) , signedDistances.data() , hitMask.data()
+		);
+		for (uint32_t dense = 0; dense < spheres.count; ++dense) {
+			uint32_t sphereSlot = spheres.denseToSlot[dense];
+			if (!cache.isSphereDirty[sphereSlot]) {
+				UpdatePairHit(cache , sphereSlot , planeSlot , (hitMask[dense / 64] >> (dense % 64)) & 1);
+				++cache.retestCount;
+			}
+		}
+	}
+
+	//色は当たっている平面の数から決める
+	for (uint32_t i = 0; i < spheres.count; ++i) {
+		uint32_t sphereSlot = spheres.denseToSlot[i];
+		scene.spheres.colors[i] = cache.hitCounts[sphereSlot] > 0 ? kColorRed : kColorWhite;
+	}
+}
+
+uint32_t DrawScene(JobSystem &jobSystem , const RenderContext &context , const Scene &scene , LineBatch &output) {
+	uint32_t sphereCount = scene.spheres.count;
+	uint32_t planeCount = scene.planes.count;
+
+	return DrawParallel(jobSystem , context , sphereCount + planeCount , output , [&](size_t index , const RenderContext &chunkContext) {
+		if (index < sphereCount) {
+			return DrawSphere(GetSphereAt(scene , uint32_t(index)) , chunkContext , scene.spheres.colors[index]);
+		}
+		uint32_t planeIndex = uint32_t(index - sphereCount);
+		return DrawPlane(GetPlaneAt(scene , planeIndex) , chunkContext , scene.planes.colors[planeIndex]);
+	});
+}
+
+bool SaveSceneFile(const Scene &scene , const char *filePath) {
+	SceneFileWriter writer;
+	if (!writer.Open(filePath , scene.spheres.count , scene.planes.count)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < scene.spheres.count; ++i) {
+		writer.AddSphere(GetSphereAt(scene , i) , scene.spheres.colors[i]);
+	}
+	for (uint32_t i = 0; i < scene.planes.count; ++i) {
+		writer.AddPlane(GetPlaneAt(scene , i) , scene.planes.colors[i]);
+	}
+	return writer.Close();
+}
+
+uint32_t DrawSceneFile(JobSystem &jobSystem , const RenderContext &context , const SceneFile &sceneFile , LineBatch &output) {
+	uint32_t sphereCount = sceneFile.GetSphereCount();
+	uint32_t planeCount = sceneFile.GetPlaneCount();
+
+	return DrawParallel(jobSystem , context , sphereCount + planeCount , output , [&](size_t index , const RenderContext &chunkContext) {
+		if (index < sphereCount) {
+			return DrawSphere(sceneFile.GetSphere(uint32_t(index)) , chunkContext , sceneFile.GetSphereColors()[index]);
+		}
+		uint32_t planeIndex = uint32_t(index - sphereCount);
+		return DrawPlane(sceneFile.GetPlane(planeIndex) , chunkContext , sceneFile.GetPlaneColors()[planeIndex]);
+	});
+}
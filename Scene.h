@@ -0,0 +1,114 @@
+#pragma once
+#include "Collision.h"
+#include "JobSystem.h"
+#include "LineBatch.h"
+#include "MyMath.h"
+#include "Render.h"
+#include "SceneFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//球と平面をSoAで持つシーンと、変わった物だけの当たり判定(Noviceに依存しない)
+
+//シーンのオブジェクトを指すハンドル(消された後に同じ場所が使われても世代で見分ける)
+struct SceneHandle {
+	uint32_t slot;
+	uint32_t generation;
+};
+
+//最初に1回だけ確保して切り分けるメモリ
+struct Arena {
+	std::unique_ptr<uint8_t[]> buffer;
+	size_t size;
+	size_t offset;
+};
+
+//SoAのオブジェクトプール
+//生きているオブジェクトは columns[][0 .. count) に詰めて並べる(削除は末尾と入れ替え)
+//ハンドルはslotを指し、slotから今の並び順の位置を引く
+template<size_t kColumnCount>
+struct SoAPool {
+	uint32_t capacity;
+	uint32_t count;
+	float *columns[kColumnCount];
+	uint32_t *colors;
+	uint32_t *denseToSlot;
+	uint32_t *slotToDense;
+	uint32_t *generations;
+	uint32_t *versions; //slotごと。中身が変わるたびに増やす(当たり判定のキャッシュ用)
+	uint32_t *freeSlots;
+	uint32_t freeCount;
+};
+
+//球と平面の当たりの出入り
+enum CollisionEventType {
+	kCollisionEnter ,
+	kCollisionStay ,
+	kCollisionExit
+};
+
+struct CollisionEvent {
+	SceneHandle sphere;
+	SceneHandle plane;
+	CollisionEventType type;
+};
+
+//球と平面のペアの結果をフレームをまたいで覚えておく
+//どちらのversionも変わっていないペアは判定し直さない
+struct SceneCollisionCache {
+	std::vector<uint32_t> sphereVersions; //最後に判定した時のversion(slotごと)
+	std::vector<uint32_t> planeVersions;
+	std::vector<uint32_t> sphereGenerations; //最後に判定した時の世代(消えた物のExit用)
+	std::vector<uint32_t> planeGenerations;
+	std::vector<uint8_t> isSphereDirty;
+	std::vector<uint8_t> isPlaneDirty;
+	std::vector<uint64_t> pairHits; //球のslotごとに、当たっている平面のslotのbit
+	size_t pairWordCount; //球1つ分のpairHitsの数
+	std::vector<uint32_t> hitCounts; //球のslotごとの当たっている平面の数
+	std::vector<CollisionEvent> events; //このフレームのイベント
+	uint32_t retestCount; //このフレームで判定し直したペアの数
+};
+
+//球と平面をSoAで持つシーン
+//容量は最初に決め、追加・削除ではヒープを使わない
+struct Scene {
+	Arena arena;
+	SoAPool<4> spheres; //x , y , z , radius
+	SoAPool<4> planes; //normal.x , normal.y , normal.z , distance
+	SceneCollisionCache collision;
+};
+
+void InitializeScene(Scene &scene , uint32_t sphereCapacity , uint32_t planeCapacity);
+
+SceneHandle AddSphere(Scene &scene , const Sphere &sphere , uint32_t color);
+SceneHandle AddPlane(Scene &scene , const Plane &plane , uint32_t color);
+void RemoveSphere(Scene &scene , SceneHandle handle);
+void RemovePlane(Scene &scene , SceneHandle handle);
+
+//並び順の位置から取り出す
+Sphere GetSphereAt(const Scene &scene , uint32_t index);
+Plane GetPlaneAt(const Scene &scene , uint32_t index);
+
+Sphere GetSphere(const Scene &scene , SceneHandle handle);
+Plane GetPlane(const Scene &scene , SceneHandle handle);
+
+//同じ値を入れた時はversionが変わらないので、毎フレーム書き戻しても判定し直さない
+void SetSphere(Scene &scene , SceneHandle handle , const Sphere &sphere);
+void SetPlane(Scene &scene , SceneHandle handle , const Plane &plane);
+
+bool IsPairHit(const SceneCollisionCache &cache , uint32_t sphereSlot , uint32_t planeSlot);
+
+//変わった球と平面のペアだけ判定し直し、Enter/Stay/Exitを出す
+//どれかの平面に当たっている球を赤くする
+void UpdateSceneCollision(Scene &scene);
+
+//シーンの球と平面を並列に描く。戻り値は描いた数
+uint32_t DrawScene(JobSystem &jobSystem , const RenderContext &context , const Scene &scene , LineBatch &output);
+
+//シーンの球と平面をシーンファイルに保存する
+bool SaveSceneFile(const Scene &scene , const char *filePath);
+
+//シーンファイルの球と平面を並列に描く(mmapした列をそのまま読む)。戻り値は描いた数
+uint32_t DrawSceneFile(JobSystem &jobSystem , const RenderContext &context , const SceneFile &sceneFile , LineBatch &output);
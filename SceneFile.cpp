@@ -0,0 +1,312 @@
+#include "SceneFile.h"
+#include <bit>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//ファイルはリトルエンディアンと決めていて、読む時に並べ替えないので
+static_assert(std::endian::native == std::endian::little , "SceneFile requires a little-endian host");
+
+namespace {
+
+const char kSceneFileMagic[8] = {'M', 'T', '3', 'S', 'C', 'E', 'N', 'E'};
+const uint32_t kSceneFileEndianTag = 0x01020304;
+
+//ヘッダの数から決まる並び
+struct SceneFileLayout {
+	uint64_t sphereOffset;
+	uint64_t planeOffset;
+	uint64_t fileSize;
+};
+
+SceneFileLayout MakeSceneFileLayout(uint32_t sphereCount , uint32_t planeCount) {
+	SceneFileLayout layout;
+	layout.sphereOffset = sizeof(SceneFileHeader);
+	layout.planeOffset = layout.sphereOffset + GetSceneFileColumnStride(sphereCount) * kSceneFileColumnCount;
+	layout.fileSize = layout.planeOffset + GetSceneFileColumnStride(planeCount) * kSceneFileColumnCount;
+	return layout;
+}
+
+bool SeekFile(FILE *file , uint64_t offset) {
+#if defined(_MSC_VER)
+	return _fseeki64(file , int64_t(offset) , SEEK_SET) == 0;
+#else
+	return fseeko(file , off_t(offset) , SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+uint64_t GetSceneFileColumnStride(uint32_t count) {
+	uint64_t size = uint64_t(count) * sizeof(float);
+	return (size + kSceneFileAlignment - 1) / kSceneFileAlignment * kSceneFileAlignment;
+}
+
+SceneFileWriter::~SceneFileWriter() {
+	//Closeされなかったファイルはヘッダが無いまま閉じる
+	if (file_) {
+		std::fclose(file_);
+	}
+}
+
+bool SceneFileWriter::Open(const char *filePath , uint32_t sphereCount , uint32_t planeCount) {
+	if (file_) {
+		return false;
+	}
+#if defined(_MSC_VER)
+	if (fopen_s(&file_ , filePath , "wb") != 0) {
+		file_ = nullptr;
+		return false;
+	}
+#else
+	file_ = std::fopen(filePath , "wb");
+#endif
+	if (file_ == nullptr) {
+		return false;
+	}
+
+	SceneFileLayout layout = MakeSceneFileLayout(sphereCount , planeCount);
+	spheres_ = {};
+	spheres_.offset = layout.sphereOffset;
+	spheres_.count = sphereCount;
+	planes_ = {};
+	planes_.offset = layout.planeOffset;
+	planes_.count = planeCount;
+	isFailed_ = false;
+
+	//ヘッダは0で埋めておき、最後のbyteを書いて大きさを確保する(間は0になる)
+	SceneFileHeader emptyHeader = {};
+	if (std::fwrite(&emptyHeader , sizeof(emptyHeader) , 1 , file_) != 1) {
+		isFailed_ = true;
+	}
+	if (layout.fileSize > sizeof(SceneFileHeader)) {
+		const uint8_t zero = 0;
+		if (!SeekFile(file_ , layout.fileSize - 1) || std::fwrite(&zero , 1 , 1 , file_) != 1) {
+			isFailed_ = true;
+		}
+	}
+	return !isFailed_;
+}
+
+bool SceneFileWriter::AddSphere(const Sphere &sphere , uint32_t color) {
+	const float values[4] = {sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius};
+	return Add(spheres_ , values , color);
+}
+
+bool SceneFileWriter::AddPlane(const Plane &plane , uint32_t color) {
+	const float values[4] = {plane.normal.x, plane.normal.y, plane.normal.z, plane.distance};
+	return Add(planes_ , values , color);
+}
+
+bool SceneFileWriter::Add(Section &section , const float (&values)[4] , uint32_t color) {
+	if (!file_ || isFailed_ || section.writtenCount + section.colors.size() >= section.count) {
+		return false;
+	}
+	for (size_t i = 0; i < 4; ++i) {
+		section.columns[i].push_back(values[i]);
+	}
+	section.colors.push_back(color);
+
+	if (section.colors.size() >= kChunkSize) {
+		return FlushSection(section);
+	}
+	return true;
+}
+
+bool SceneFileWriter::FlushSection(Section &section) {
+	size_t count = section.colors.size();
+	if (count == 0) {
+		return !isFailed_;
+	}
+
+	//列ごとに、ファイルのその列の続きの位置へ書く
+	uint64_t stride = GetSceneFileColumnStride(section.count);
+	uint64_t elementOffset = uint64_t(section.writtenCount) * sizeof(float);
+	for (size_t column = 0; column < kSceneFileColumnCount; ++column) {
+		const void *source = column < 4 ? static_cast<const void *>(section.columns[column].data()) : static_cast<const void *>(section.colors.data());
+		if (!SeekFile(file_ , section.offset + stride * column + elementOffset) || std::fwrite(source , sizeof(float) , count , file_) != count) {
+			isFailed_ = true;
+		}
+	}
+
+	section.writtenCount += uint32_t(count);
+	for (size_t i = 0; i < 4; ++i) {
+		section.columns[i].clear();
+	}
+	section.colors.clear();
+	return !isFailed_;
+}
+
+bool SceneFileWriter::Close() {
+	if (!file_) {
+		return false;
+	}
+
+	FlushSection(spheres_);
+	FlushSection(planes_);
+	bool isComplete = !isFailed_ && spheres_.writtenCount == spheres_.count && planes_.writtenCount == planes_.count;
+
+	if (isComplete) {
+		SceneFileLayout layout = MakeSceneFileLayout(spheres_.count , planes_.count);
+		SceneFileHeader header = {};
+		std::memcpy(header.magic , kSceneFileMagic , sizeof(header.magic));
+		header.version = kSceneFileVersion;
+		header.endianTag = kSceneFileEndianTag;
+		header.headerSize = sizeof(SceneFileHeader);
+		header.sphereCount = spheres_.count;
+		header.planeCount = planes_.count;
+		header.sphereOffset = layout.sphereOffset;
+		header.planeOffset = layout.planeOffset;
+		header.fileSize = layout.fileSize;
+		isComplete = SeekFile(file_ , 0) && std::fwrite(&header , sizeof(header) , 1 , file_) == 1;
+	}
+
+	if (std::fclose(file_) != 0) {
+		isComplete = false;
+	}
+	file_ = nullptr;
+	return isComplete;
+}
+
+SceneFile::~SceneFile() {
+	Close();
+}
+
+bool SceneFile::Open(const char *filePath) {
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filePath , GENERIC_READ , FILE_SHARE_READ , nullptr , OPEN_EXISTING , FILE_ATTRIBUTE_NORMAL , nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	fileHandle_ = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file , &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(SceneFileHeader))) {
+		Close();
+		return false;
+	}
+	mappingHandle_ = CreateFileMappingA(file , nullptr , PAGE_READONLY , 0 , 0 , nullptr);
+	if (mappingHandle_ == nullptr) {
+		Close();
+		return false;
+	}
+	data_ = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle_ , FILE_MAP_READ , 0 , 0 , 0));
+	if (data_ == nullptr) {
+		Close();
+		return false;
+	}
+	size_ = size_t(fileSize.QuadPart);
+#else
+	int file = open(filePath , O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(file , &status) != 0 || status.st_size < off_t(sizeof(SceneFileHeader))) {
+		close(file);
+		return false;
+	}
+	void *mapped = mmap(nullptr , size_t(status.st_size) , PROT_READ , MAP_PRIVATE , file , 0);
+	//割り当てた後はファイルを閉じても読める
+	close(file);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	data_ = static_cast<const uint8_t *>(mapped);
+	size_ = size_t(status.st_size);
+#endif
+
+	//中身は読まずに、ヘッダと並びだけ確かめる
+	const SceneFileHeader *header = reinterpret_cast<const SceneFileHeader *>(data_);
+	SceneFileLayout layout = MakeSceneFileLayout(header->sphereCount , header->planeCount);
+	bool isValid =
+		std::memcmp(header->magic , kSceneFileMagic , sizeof(header->magic)) == 0 &&
+		header->version == kSceneFileVersion &&
+		header->endianTag == kSceneFileEndianTag &&
+		header->headerSize == sizeof(SceneFileHeader) &&
+		header->sphereOffset == layout.sphereOffset &&
+		header->planeOffset == layout.planeOffset &&
+		header->fileSize == layout.fileSize &&
+		layout.fileSize <= size_;
+	if (!isValid) {
+		Close();
+		return false;
+	}
+	header_ = header;
+	return true;
+}
+
+void SceneFile::Close() {
+#if defined(_WIN32)
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mappingHandle_) {
+		CloseHandle(mappingHandle_);
+	}
+	if (fileHandle_) {
+		CloseHandle(fileHandle_);
+	}
+	mappingHandle_ = nullptr;
+	fileHandle_ = nullptr;
+#else
+	if (data_) {
+		munmap(const_cast<uint8_t *>(data_) , size_);
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	header_ = nullptr;
+}
+
+const uint8_t *SceneFile::GetColumn(uint64_t sectionOffset , uint32_t count , size_t index) const {
+	if (!header_ || index >= kSceneFileColumnCount) {
+		return nullptr;
+	}
+	return data_ + sectionOffset + GetSceneFileColumnStride(count) * index;
+}
+
+const float *SceneFile::GetSphereColumn(size_t index) const {
+	if (index >= 4) {
+		return nullptr;
+	}
+	return reinterpret_cast<const float *>(GetColumn(header_ ? header_->sphereOffset : 0 , GetSphereCount() , index));
+}
+
+const uint32_t *SceneFile::GetSphereColors() const {
+	return reinterpret_cast<const uint32_t *>(GetColumn(header_ ? header_->sphereOffset : 0 , GetSphereCount() , 4));
+}
+
+const float *SceneFile::GetPlaneColumn(size_t index) const {
+	if (index >= 4) {
+		return nullptr;
+	}
+	return reinterpret_cast<const float *>(GetColumn(header_ ? header_->planeOffset : 0 , GetPlaneCount() , index));
+}
+
+const uint32_t *SceneFile::GetPlaneColors() const {
+	return reinterpret_cast<const uint32_t *>(GetColumn(header_ ? header_->planeOffset : 0 , GetPlaneCount() , 4));
+}
+
+Sphere SceneFile::GetSphere(uint32_t index) const {
+	return {{GetSphereColumn(0)[index], GetSphereColumn(1)[index], GetSphereColumn(2)[index]}, GetSphereColumn(3)[index]};
+}
+
+Plane SceneFile::GetPlane(uint32_t index) const {
+	return {{GetPlaneColumn(0)[index], GetPlaneColumn(1)[index], GetPlaneColumn(2)[index]}, GetPlaneColumn(3)[index]};
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Collision.h"
+#include "MyMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+//シーンファイル(リトルエンディアン)
+//  [ヘッダ 64byte][球: x, y, z, radius, color の列][平面: normal.x, normal.y, normal.z, distance, color の列]
+//列はどれも64byte境界から始まり、64byteの倍数まで0で埋める
+//中身はSoAPoolやSphereArrayと同じ並びなので、mmapした所をそのままカーネルに渡せる
+const uint32_t kSceneFileVersion = 1;
+const uint32_t kSceneFileAlignment = 64;
+const uint32_t kSceneFileColumnCount = 5; //float 4列 + 色
+
+struct SceneFileHeader {
+	char magic[8]; //"MT3SCENE"
+	uint32_t version;
+	uint32_t endianTag; //0x01020304 を書く。読んだ値が違えばバイト順が違う
+	uint32_t headerSize;
+	uint32_t sphereCount;
+	uint32_t planeCount;
+	uint32_t reserved0;
+	uint64_t sphereOffset; //球の最初の列の位置
+	uint64_t planeOffset; //平面の最初の列の位置
+	uint64_t fileSize;
+	uint8_t reserved1[8];
+};
+static_assert(sizeof(SceneFileHeader) == kSceneFileAlignment , "SceneFileHeader must be 64 bytes");
+
+//count個の列1本の大きさ(64byteの倍数)
+uint64_t GetSceneFileColumnStride(uint32_t count);
+
+//シーンファイルを書く
+//数を先に決めておけば、全部をメモリにためずに少しずつ書ける
+class SceneFileWriter {
+public:
+	SceneFileWriter() = default;
+	~SceneFileWriter();
+
+	SceneFileWriter(const SceneFileWriter &) = delete;
+	SceneFileWriter &operator=(const SceneFileWriter &) = delete;
+
+	//ファイルを作って大きさを確保する
+	//戻り値は開けたか
+	bool Open(const char *filePath , uint32_t sphereCount , uint32_t planeCount);
+
+	//1個ずつ足す(Openで決めた数まで)
+	bool AddSphere(const Sphere &sphere , uint32_t color);
+	bool AddPlane(const Plane &plane , uint32_t color);
+
+	//残りを書いて最後にヘッダを書く
+	//ヘッダは最後に書くので、途中で止まったファイルは開けない
+	//戻り値はOpenで決めた数が全部書けたか
+	bool Close();
+
+private:
+	//たまったらファイルの列ごとの位置へ書き出す
+	static const uint32_t kChunkSize = 16384;
+
+	struct Section {
+		uint64_t offset;
+		uint32_t count;
+		uint32_t writtenCount;
+		std::vector<float> columns[4];
+		std::vector<uint32_t> colors;
+	};
+
+	bool Add(Section &section , const float (&values)[4] , uint32_t color);
+	bool FlushSection(Section &section);
+
+	FILE *file_ = nullptr;
+	bool isFailed_ = false;
+	Section spheres_ = {};
+	Section planes_ = {};
+};
+
+//シーンファイルをmmapして読む(読み込みもコピーもしない)
+//列のポインタはCloseするまで使える
+class SceneFile {
+public:
+	SceneFile() = default;
+	~SceneFile();
+
+	SceneFile(const SceneFile &) = delete;
+	SceneFile &operator=(const SceneFile &) = delete;
+
+	//ヘッダを確かめてファイルをメモリに割り当てる
+	//戻り値は開けたか(形式が違えばfalse)
+	bool Open(const char *filePath);
+
+	void Close();
+
+	bool IsOpen() const { return header_ != nullptr; }
+
+	uint32_t GetSphereCount() const { return header_ ? header_->sphereCount : 0; }
+	uint32_t GetPlaneCount() const { return header_ ? header_->planeCount : 0; }
+
+	//0:x 1:y 2:z 3:radius
+	const float *GetSphereColumn(size_t index) const;
+	const uint32_t *GetSphereColors() const;
+	//0:normal.x 1:normal.y 2:normal.z 3:distance
+	const float *GetPlaneColumn(size_t index) const;
+	const uint32_t *GetPlaneColors() const;
+
+	Sphere GetSphere(uint32_t index) const;
+	Plane GetPlane(uint32_t index) const;
+
+private:
+	const uint8_t *GetColumn(uint64_t sectionOffset , uint32_t count , size_t index) const;
+
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+	const SceneFileHeader *header_ = nullptr;
+#if defined(_WIN32)
+	void *fileHandle_ = nullptr;
+	void *mappingHandle_ = nullptr;
+#endif
+};
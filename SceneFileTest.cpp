@@ -0,0 +1,217 @@
+//シーンファイルを書いてmmapで読み直し、列の中身と並びを確かめる(CMakeLists.txtのctest)
+#include "SceneFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//書いた物(SoAで持って、列ごとにそのまま比べる)
+struct SceneColumns {
+	std::vector<float> sphereColumns[4];
+	std::vector<uint32_t> sphereColors;
+	std::vector<float> planeColumns[4];
+	std::vector<uint32_t> planeColors;
+};
+
+//floatはbitで比べるので、-0や非正規化数もそのまま戻るかを見られる
+float MakeValue(std::mt19937 &random) {
+	const float kSpecialValues[] = {0.0f , -0.0f , 1.0e-40f , -3.4e38f , 1.0f};
+	std::uniform_int_distribution<int> kind(0 , 9);
+	int index = kind(random);
+	if (index < 5) {
+		return kSpecialValues[index];
+	}
+	return std::uniform_real_distribution<float>(-100.0f , 100.0f)(random);
+}
+
+SceneColumns MakeSceneColumns(uint32_t sphereCount , uint32_t planeCount , std::mt19937 &random) {
+	SceneColumns scene;
+	for (uint32_t i = 0; i < sphereCount; ++i) {
+		for (int column = 0; column < 4; ++column) {
+			scene.sphereColumns[column].push_back(MakeValue(random));
+		}
+		scene.sphereColors.push_back(uint32_t(random()));
+	}
+	for (uint32_t i = 0; i < planeCount; ++i) {
+		for (int column = 0; column < 4; ++column) {
+			scene.planeColumns[column].push_back(MakeValue(random));
+		}
+		scene.planeColors.push_back(uint32_t(random()));
+	}
+	return scene;
+}
+
+bool WriteSceneColumns(const std::string &filePath , const SceneColumns &scene) {
+	SceneFileWriter writer;
+	uint32_t sphereCount = uint32_t(scene.sphereColors.size());
+	uint32_t planeCount = uint32_t(scene.planeColors.size());
+	if (!writer.Open(filePath.c_str() , sphereCount , planeCount)) {
+		return false;
+	}
+	//球と平面を交互に足して、列ごとの書き出しが混ざっても大丈夫かを見る
+	for (uint32_t i = 0; i < sphereCount || i < planeCount; ++i) {
+		if (i < sphereCount) {
+			Sphere sphere = {{scene.sphereColumns[0][i], scene.sphereColumns[1][i], scene.sphereColumns[2][i]}, scene.sphereColumns[3][i]};
+			if (!writer.AddSphere(sphere , scene.sphereColors[i])) {
+				return false;
+			}
+		}
+		if (i < planeCount) {
+			Plane plane = {{scene.planeColumns[0][i], scene.planeColumns[1][i], scene.planeColumns[2][i]}, scene.planeColumns[3][i]};
+			if (!writer.AddPlane(plane , scene.planeColors[i])) {
+				return false;
+			}
+		}
+	}
+	//決めた数より多くは足せない
+	if (writer.AddSphere({{0.0f, 0.0f, 0.0f}, 1.0f} , 0) || writer.AddPlane({{0.0f, 1.0f, 0.0f}, 0.0f} , 0)) {
+		return false;
+	}
+	return writer.Close();
+}
+
+//列が64byte境界から始まり、残りが0で埋まっているか
+bool IsColumnAligned(const void *column , uint32_t count) {
+	if (reinterpret_cast<uintptr_t>(column) % kSceneFileAlignment != 0) {
+		return false;
+	}
+	const uint8_t *bytes = static_cast<const uint8_t *>(column);
+	for (uint64_t i = uint64_t(count) * sizeof(float); i < GetSceneFileColumnStride(count); ++i) {
+		if (bytes[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//戻り値は合わなかった数
+int CheckSceneFile(const std::string &filePath , const SceneColumns &scene) {
+	char name[64];
+	uint32_t sphereCount = uint32_t(scene.sphereColors.size());
+	uint32_t planeCount = uint32_t(scene.planeColors.size());
+	std::snprintf(name , sizeof(name) , "spheres %u planes %u" , sphereCount , planeCount);
+
+	if (!WriteSceneColumns(filePath , scene)) {
+		std::fprintf(stderr , "%s: write failed\n" , name);
+		return 1;
+	}
+	uint64_t expectedSize = sizeof(SceneFileHeader) + (GetSceneFileColumnStride(sphereCount) + GetSceneFileColumnStride(planeCount)) * kSceneFileColumnCount;
+	if (std::filesystem::file_size(filePath) != expectedSize) {
+		std::fprintf(stderr , "%s: file size %llu expected %llu\n" , name , static_cast<unsigned long long>(std::filesystem::file_size(filePath)) , static_cast<unsigned long long>(expectedSize));
+		return 1;
+	}
+
+	SceneFile sceneFile;
+	if (!sceneFile.Open(filePath.c_str())) {
+		std::fprintf(stderr , "%s: open failed\n" , name);
+		return 1;
+	}
+	if (sceneFile.GetSphereCount() != sphereCount || sceneFile.GetPlaneCount() != planeCount) {
+		std::fprintf(stderr , "%s: count %u , %u\n" , name , sceneFile.GetSphereCount() , sceneFile.GetPlaneCount());
+		return 1;
+	}
+
+	int failureCount = 0;
+	auto checkColumn = [&](const char *columnName , const void *actual , const void *expected , uint32_t count) {
+		if (!IsColumnAligned(actual , count)) {
+			std::fprintf(stderr , "%s: %s is not aligned or padded with zero\n" , name , columnName);
+			++failureCount;
+		}
+		if (count > 0 && std::memcmp(actual , expected , count * sizeof(float)) != 0) {
+			std::fprintf(stderr , "%s: %s differs\n" , name , columnName);
+			++failureCount;
+		}
+	};
+	const char *const kColumnNames[4] = {"x", "y", "z", "w"};
+	for (int column = 0; column < 4; ++column) {
+		checkColumn(kColumnNames[column] , sceneFile.GetSphereColumn(column) , scene.sphereColumns[column].data() , sphereCount);
+		checkColumn(kColumnNames[column] , sceneFile.GetPlaneColumn(column) , scene.planeColumns[column].data() , planeCount);
+	}
+	checkColumn("sphere colors" , sceneFile.GetSphereColors() , scene.sphereColors.data() , sphereCount);
+	checkColumn("plane colors" , sceneFile.GetPlaneColors() , scene.planeColors.data() , planeCount);
+
+	//1個ずつ取り出しても同じ
+	for (uint32_t i = 0; i < sphereCount; ++i) {
+		Sphere sphere = sceneFile.GetSphere(i);
+		if (std::memcmp(&sphere.radius , &scene.sphereColumns[3][i] , sizeof(float)) != 0) {
+			std::fprintf(stderr , "%s: GetSphere(%u) differs\n" , name , i);
+			++failureCount;
+			break;
+		}
+	}
+	for (uint32_t i = 0; i < planeCount; ++i) {
+		Plane plane = sceneFile.GetPlane(i);
+		if (std::memcmp(&plane.distance , &scene.planeColumns[3][i] , sizeof(float)) != 0) {
+			std::fprintf(stderr , "%s: GetPlane(%u) differs\n" , name , i);
+			++failureCount;
+			break;
+		}
+	}
+	return failureCount;
+}
+
+//開けてはいけないファイル。戻り値は開けてしまった数
+int CheckRejected(const std::string &filePath , const char *name) {
+	SceneFile sceneFile;
+	if (sceneFile.Open(filePath.c_str())) {
+		std::fprintf(stderr , "%s: opened\n" , name);
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace
+
+int main() {
+	std::mt19937 random(20240617);
+	std::string filePath = (std::filesystem::temp_directory_path() / "MT3SceneFileTest.bin").string();
+
+	int failureCount = 0;
+
+	//空、64byteちょうど、端数、書き出しのまとまり(16384個)をまたぐ数
+	const uint32_t kCounts[][2] = {{0 , 0} , {1 , 0} , {0 , 3} , {16 , 16} , {17 , 5} , {40000 , 70}};
+	for (const uint32_t (&counts)[2] : kCounts) {
+		failureCount += CheckSceneFile(filePath , MakeSceneColumns(counts[0] , counts[1] , random));
+	}
+
+	//途中で止めたファイル(ヘッダが書かれない)
+	{
+		SceneFileWriter writer;
+		writer.Open(filePath.c_str() , 4 , 1);
+		writer.AddSphere({{1.0f, 2.0f, 3.0f}, 1.0f} , 0xFFFFFFFF);
+		if (writer.Close()) {
+			std::fprintf(stderr , "incomplete: Close succeeded\n");
+			++failureCount;
+		}
+		failureCount += CheckRejected(filePath , "incomplete");
+	}
+
+	//後ろが切れたファイルと、ヘッダより短いファイル
+	{
+		WriteSceneColumns(filePath , MakeSceneColumns(100 , 10 , random));
+		uint64_t size = std::filesystem::file_size(filePath);
+		std::filesystem::resize_file(filePath , size - 1);
+		failureCount += CheckRejected(filePath , "truncated");
+		std::filesystem::resize_file(filePath , sizeof(SceneFileHeader) - 1);
+		failureCount += CheckRejected(filePath , "shorter than header");
+	}
+
+	//版が違うファイル
+	{
+		WriteSceneColumns(filePath , MakeSceneColumns(3 , 1 , random));
+		FILE *file = std::fopen(filePath.c_str() , "r+b");
+		uint32_t version = kSceneFileVersion + 1;
+		std::fseek(file , offsetof(SceneFileHeader , version) , SEEK_SET);
+		std::fwrite(&version , sizeof(version) , 1 , file);
+		std::fclose(file);
+		failureCount += CheckRejected(filePath , "other version");
+	}
+
+	std::filesystem::remove(filePath);
+	std::printf("SceneFile: failures %d\n" , failureCount);
+	return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "SoftwareRasterizer.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+//Cohen-Sutherlandの領域コード
+const int kInside = 0;
+const int kLeft = 1;
+const int kRight = 2;
+const int kBottom = 4;
+const int kTop = 8;
+
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(int width , int height)
+	: width_(width) , height_(height) , pixels_(size_t(width) * size_t(height) , 0x000000FF) {
+	assert(width > 0 && height > 0);
+}
+
+void SoftwareRasterizer::Clear(uint32_t color) {
+	for (uint32_t &pixel : pixels_) {
+		pixel = color;
+	}
+}
+
+bool SoftwareRasterizer::ClipLine(double &x1 , double &y1 , double &x2 , double &y2) const {
+	const double xMax = double(width_ - 1);
+	const double yMax = double(height_ - 1);
+
+	auto computeCode = [&](double x , double y) {
+		int code = kInside;
+		if (x < 0.0) {
+			code |= kLeft;
+		} else if (x > xMax) {
+			code |= kRight;
+		}
+		if (y < 0.0) {
+			code |= kTop;
+		} else if (y > yMax) {
+			code |= kBottom;
+		}
+		return code;
+	};
+
+	int code1 = computeCode(x1 , y1);
+	int code2 = computeCode(x2 , y2);
+
+	while (true) {
+		if ((code1 | code2) == 0) {
+			return true;
+		}
+		if ((code1 & code2) != 0) {
+			return false;
+		}
+
+		//外側にある方の端点を境界まで動かす
+		int code = code1 != 0 ? code1 : code2;
+		double x = 0.0;
+		double y = 0.0;
+		if (code & kBottom) {
+			x = x1 + (x2 - x1) * (yMax - y1) / (y2 - y1);
+			y = yMax;
+		} else if (code & kTop) {
+			x = x1 + (x2 - x1) * (0.0 - y1) / (y2 - y1);
+			y = 0.0;
+		} else if (code & kRight) {
+			y = y1 + (y2 - y1) * (xMax - x1) / (x2 - x1);
+			x = xMax;
+		} else {
+			y = y1 + (y2 - y1) * (0.0 - x1) / (x2 - x1);
+			x = 0.0;
+		}
+
+		if (code == code1) {
+			x1 = x;
+			y1 = y;
+			code1 = computeCode(x1 , y1);
+		} else {
+			x2 = x;
+			y2 = y;
+			code2 = computeCode(x2 , y2);
+		}
+	}
+}
+
+void SoftwareRasterizer::DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) {
+	double clippedX1 = x1;
+	double clippedY1 = y1;
+	double clippedX2 = x2;
+	double clippedY2 = y2;
+	if (!ClipLine(clippedX1 , clippedY1 , clippedX2 , clippedY2)) {
+		return;
+	}
+
+	int x = int(std::lround(clippedX1));
+	int y = int(std::lround(clippedY1));
+	int endX = int(std::lround(clippedX2));
+	int endY = int(std::lround(clippedY2));
+
+	//Bresenham
+	int dx = std::abs(endX - x);
+	int dy = -std::abs(endY - y);
+	int stepX = x < endX ? 1 : -1;
+	int stepY = y < endY ? 1 : -1;
+	int error = dx + dy;
+
+	while (true) {
+		pixels_[size_t(y) * size_t(width_) + size_t(x)] = color;
+		if (x == endX && y == endY) {
+			break;
+		}
+		int error2 = error * 2;
+		if (error2 >= dy) {
+			error += dy;
+			x += stepX;
+		}
+		if (error2 <= dx) {
+			error += dx;
+			y += stepY;
+		}
+	}
+}
+
+bool SoftwareRasterizer::SavePPM(const char *filePath) const {
+	FILE *file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file , filePath , "wb") != 0) {
+		return false;
+	}
+#else
+	file = std::fopen(filePath , "wb");
+#endif
+	if (file == nullptr) {
+		return false;
+	}
+
+	std::fprintf(file , "P6\n%d %d\n255\n" , width_ , height_);
+
+	std::vector<uint8_t> rgb(pixels_.size() * 3);
+	for (size_t i = 0; i < pixels_.size(); ++i) {
+		rgb[i * 3 + 0] = uint8_t(pixels_[i] >> 24);
+		rgb[i * 3 + 1] = uint8_t(pixels_[i] >> 16);
+		rgb[i * 3 + 2] = uint8_t(pixels_[i] >> 8);
+	}
+	size_t written = std::fwrite(rgb.data() , 1 , rgb.size() , file);
+	std::fclose(file);
+
+	return written == rgb.size();
+}
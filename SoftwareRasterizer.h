@@ -0,0 +1,33 @@
+#pragma once
+#include "LineSink.h"
+#include <cstdint>
+#include <vector>
+
+//ウィンドウを使わずメモリ上の画像に線を描く
+class SoftwareRasterizer : public LineSink {
+public:
+	SoftwareRasterizer(int width , int height);
+
+	//全画面を1色で塗る
+	void Clear(uint32_t color);
+
+	//画面外は切り取ってBresenhamで描く
+	void DrawLine(int x1 , int y1 , int x2 , int y2 , uint32_t color) override;
+
+	//バイナリPPM(P6)で保存する
+	//戻り値は保存できたか
+	bool SavePPM(const char *filePath) const;
+
+	int GetWidth() const { return width_; }
+	int GetHeight() const { return height_; }
+	const std::vector<uint32_t> &GetPixels() const { return pixels_; }
+
+private:
+	//線を画面の範囲に切り取る(Cohen-Sutherland)
+	//戻り値は画面に残る部分があるか
+	bool ClipLine(double &x1 , double &y1 , double &x2 , double &y2) const;
+
+	int width_ = 0;
+	int height_ = 0;
+	std::vector<uint32_t> pixels_; //0xRRGGBBAA
+};